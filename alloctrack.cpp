@@ -0,0 +1,44 @@
+#include "alloctrack.h"
+#include <cstdlib>
+#include <new>
+
+#if INVADERS_TRACK_ALLOCS
+static thread_local std::uint64_t threadAllocations = 0;
+
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+std::uint64_t allocationCount() {
+    return threadAllocations;
+}
+#else
+std::uint64_t allocationCount() {
+    return 0;
+}
+#endif
+
+std::uint64_t AllocationStats::endFrame(int state) {
+    std::uint64_t now = allocationCount();
+    std::uint64_t count = now - last;
+    last = now;
+    if (state >= 0 && state < ALLOC_TRACK_STATES) {
+        total[state] += count;
+        frames[state]++;
+        if (count > worst[state]) worst[state] = count;
+    }
+    return count;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocation counting. On by default in debug builds; define
+// INVADERS_TRACK_ALLOCS=1 or 0 to force it. When on, alloctrack.cpp replaces
+// the global operator new and counts every call per thread.
+#ifndef INVADERS_TRACK_ALLOCS
+#ifdef NDEBUG
+#define INVADERS_TRACK_ALLOCS 0
+#else
+#define INVADERS_TRACK_ALLOCS 1
+#endif
+#endif
+
+const int ALLOC_TRACK_STATES = 8;
+
+// Allocations made by the calling thread so far; always 0 when tracking is
+// compiled out.
+std::uint64_t allocationCount();
+
+// Splits the calling thread's allocations into frames and attributes each
+// frame to a caller-defined state (the front end uses GameState).
+struct AllocationStats {
+    std::uint64_t last = 0;
+    std::uint64_t total[ALLOC_TRACK_STATES] = {};
+    std::uint64_t frames[ALLOC_TRACK_STATES] = {};
+    std::uint64_t worst[ALLOC_TRACK_STATES] = {};
+
+    AllocationStats() : last(allocationCount()) {}
+
+    // Returns the allocations since the previous call.
+    std::uint64_t endFrame(int state);
+};
@@ -0,0 +1,143 @@
+#include "assetpack.h"
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static std::uint32_t readU32(const std::uint8_t* bytes) {
+    std::uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) value = (value << 8) | bytes[i];
+    return value;
+}
+
+static std::uint64_t readU64(const std::uint8_t* bytes) {
+    std::uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) value = (value << 8) | bytes[i];
+    return value;
+}
+
+// Maps the file and closes the handles straight away; the view stays valid
+// until it is unmapped.
+static const std::uint8_t* mapFile(const std::string& path, std::size_t& size) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return nullptr;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return nullptr;
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    return static_cast<const std::uint8_t*>(view);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return nullptr;
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0) {
+        ::close(file);
+        return nullptr;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED) return nullptr;
+    size = static_cast<std::size_t>(info.st_size);
+    return static_cast<const std::uint8_t*>(view);
+#endif
+}
+
+static void unmapFile(const std::uint8_t* data, std::size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<std::uint8_t*>(data), size);
+#endif
+}
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+    std::size_t mappedSize = 0;
+    const std::uint8_t* mapped = mapFile(path, mappedSize);
+    if (!mapped) return false;
+
+    // Every entry is checked once here, so find() can trust the index.
+    bool valid = mappedSize >= ASSET_PACK_HEADER_SIZE && std::memcmp(mapped, "INVA", 4) == 0 && readU32(mapped + 4) == ASSET_PACK_VERSION;
+    std::uint32_t count = valid ? readU32(mapped + 8) : 0;
+    valid = valid && count <= (mappedSize - ASSET_PACK_HEADER_SIZE) / ASSET_PACK_ENTRY_SIZE;
+    for (std::uint32_t i = 0; valid && i < count; i++) {
+        const std::uint8_t* entry = mapped + ASSET_PACK_HEADER_SIZE + i * ASSET_PACK_ENTRY_SIZE;
+        std::uint64_t offset = readU64(entry + ASSET_NAME_LENGTH);
+        std::uint64_t length = readU64(entry + ASSET_NAME_LENGTH + 8);
+        valid = entry[ASSET_NAME_LENGTH - 1] == 0 && offset <= mappedSize && length <= mappedSize - offset;
+    }
+    if (!valid) {
+        unmapFile(mapped, mappedSize);
+        return false;
+    }
+
+    data = mapped;
+    size = mappedSize;
+    entryCount = count;
+    return true;
+}
+
+void AssetPack::close() {
+    if (data) unmapFile(data, size);
+    data = nullptr;
+    size = 0;
+    entryCount = 0;
+}
+
+bool AssetPack::find(const std::string& name, const void*& bytes, std::size_t& length) const {
+    for (std::uint32_t i = 0; i < entryCount; i++) {
+        const std::uint8_t* entry = data + ASSET_PACK_HEADER_SIZE + i * ASSET_PACK_ENTRY_SIZE;
+        if (std::strncmp(reinterpret_cast<const char*>(entry), name.c_str(), ASSET_NAME_LENGTH) == 0) {
+            bytes = data + readU64(entry + ASSET_NAME_LENGTH);
+            length = static_cast<std::size_t>(readU64(entry + ASSET_NAME_LENGTH + 8));
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string AssetPack::entryName(std::uint32_t index) const {
+    return reinterpret_cast<const char*>(data + ASSET_PACK_HEADER_SIZE + index * ASSET_PACK_ENTRY_SIZE);
+}
+
+std::uint64_t AssetPack::entrySize(std::uint32_t index) const {
+    return readU64(data + ASSET_PACK_HEADER_SIZE + index * ASSET_PACK_ENTRY_SIZE + ASSET_NAME_LENGTH + 8);
+}
+
+std::string executableDirectory(const char* argv0) {
+    std::string path;
+#if defined(_WIN32)
+    char buffer[MAX_PATH];
+    DWORD length = GetModuleFileNameA(nullptr, buffer, sizeof(buffer));
+    if (length > 0 && length < sizeof(buffer)) path.assign(buffer, length);
+#elif defined(__linux__)
+    char buffer[4096];
+    ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer));
+    if (length > 0 && length < static_cast<ssize_t>(sizeof(buffer))) path.assign(buffer, static_cast<std::size_t>(length));
+#endif
+    if (path.empty() && argv0) path = argv0;
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
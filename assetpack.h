@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Asset pack layout (little endian):
+//   header  "INVA" u32 version u32 entryCount u32 reserved
+//   index   entryCount x [char name[32] u64 offset u64 size], names NUL padded
+//   data    each file's bytes, starting on a 16-byte boundary
+// Offsets are from the start of the pack. tools/packer.cpp writes it.
+
+const std::uint32_t ASSET_PACK_VERSION = 1;
+const int ASSET_NAME_LENGTH = 32;
+const std::size_t ASSET_PACK_HEADER_SIZE = 16;
+const std::size_t ASSET_PACK_ENTRY_SIZE = ASSET_NAME_LENGTH + 16;
+const std::size_t ASSET_PACK_ALIGNMENT = 16;
+const char* const ASSET_PACK_FILE = "assets.pak";
+
+// A whole pack mapped read-only into memory. find() hands out pointers into
+// the mapping, so anything that keeps them (sf::Font does) must not outlive
+// the pack.
+struct AssetPack {
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::uint32_t entryCount = 0;
+
+    AssetPack() = default;
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+    ~AssetPack();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    bool find(const std::string& name, const void*& bytes, std::size_t& length) const;
+    std::string entryName(std::uint32_t index) const;
+    std::uint64_t entrySize(std::uint32_t index) const;
+};
+
+// Directory of the running executable with a trailing separator, where the
+// pack is looked for. Asks the system on Windows and Linux and falls back to
+// argv0, which only helps when the game was started by path; empty when
+// neither says.
+std::string executableDirectory(const char* argv0);
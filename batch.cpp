@@ -0,0 +1,32 @@
+#include "batch.h"
+
+SpriteBatch::SpriteBatch(const sf::Texture* batchTexture) : vertices(sf::Quads), texture(batchTexture) {
+}
+
+void SpriteBatch::begin() {
+    vertices.clear();
+}
+
+void SpriteBatch::addSprite(float x, float y, const sf::IntRect& textureRect, const sf::Color& color) {
+    float width = static_cast<float>(textureRect.width);
+    float height = static_cast<float>(textureRect.height);
+    float left = static_cast<float>(textureRect.left);
+    float top = static_cast<float>(textureRect.top);
+
+    vertices.append(sf::Vertex(sf::Vector2f(x, y), color, sf::Vector2f(left, top)));
+    vertices.append(sf::Vertex(sf::Vector2f(x + width, y), color, sf::Vector2f(left + width, top)));
+    vertices.append(sf::Vertex(sf::Vector2f(x + width, y + height), color, sf::Vector2f(left + width, top + height)));
+    vertices.append(sf::Vertex(sf::Vector2f(x, y + height), color, sf::Vector2f(left, top + height)));
+}
+
+void SpriteBatch::addRect(float x, float y, float width, float height, const sf::Color& color) {
+    vertices.append(sf::Vertex(sf::Vector2f(x, y), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x + width, y), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x + width, y + height), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x, y + height), color));
+}
+
+void SpriteBatch::draw(sf::RenderTarget& target) const {
+    if (vertices.getVertexCount() == 0) return;
+    target.draw(vertices, sf::RenderStates(texture));
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+// Collects quads that share one texture (or none, for flat-coloured shapes) and
+// submits them with a single draw call. The vertex storage is kept between
+// frames, so after the first frame begin() and add*() never allocate.
+struct SpriteBatch {
+    sf::VertexArray vertices;
+    const sf::Texture* texture = nullptr;
+
+    explicit SpriteBatch(const sf::Texture* batchTexture = nullptr);
+
+    void begin();
+    void addSprite(float x, float y, const sf::IntRect& textureRect, const sf::Color& color = sf::Color::White);
+    void addRect(float x, float y, float width, float height, const sf::Color& color);
+    void draw(sf::RenderTarget& target) const;
+};
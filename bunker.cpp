@@ -0,0 +1,91 @@
+#include "bunker.h"
+#include <algorithm>
+#include <cmath>
+
+const int STAMP_WIDTH = 8;
+const int STAMP_HEIGHT = 8;
+// Width of the column hit tests use: stamp bits 3 and 4, which every stamp
+// row but the deepest clears.
+const int SHOT_CORE = 2;
+
+// Ragged blast shapes, bit x is pixel x, first row is where the shot struck.
+static const std::uint8_t shotStamp[STAMP_HEIGHT] = {
+    0x18, 0x3c, 0x7e, 0xff, 0x7e, 0xdb, 0x5a, 0x24,
+};
+
+static std::uint64_t spanBits(int left, int right) {
+    int span = right - left;
+    if (span <= 0) return 0;
+    return (span == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << span) - 1) << left;
+}
+
+void Bunker::reset(float left, float top) {
+    x = left;
+    y = top;
+
+    const int corner = 8;
+    const int archWidth = 16;
+    const int archHeight = 10;
+    const int archLeft = (BUNKER_WIDTH - archWidth) / 2;
+
+    for (int row = 0; row < BUNKER_HEIGHT; row++) {
+        int inset = std::max(corner - row, 0);
+        rows[row] = spanBits(inset, BUNKER_WIDTH - inset);
+
+        int archRow = row - (BUNKER_HEIGHT - archHeight);
+        if (archRow >= 0) {
+            // Round off the top of the arch by narrowing its first rows.
+            int round = std::max(3 - archRow, 0);
+            rows[row] &= ~spanBits(archLeft + round, archLeft + archWidth - round);
+        }
+    }
+}
+
+Rect Bunker::bounds() const {
+    return { x, y, static_cast<float>(BUNKER_WIDTH), static_cast<float>(BUNKER_HEIGHT) };
+}
+
+int Bunker::firstSolidRow(float centerX, float top, float height, bool downward) const {
+    // Same rounding as erode(), so the column lines up with the stamp.
+    int center = static_cast<int>(std::floor(centerX - x));
+    int left = std::max(center - SHOT_CORE / 2, 0);
+    int right = std::min(center + SHOT_CORE / 2, BUNKER_WIDTH);
+    int first = std::max(static_cast<int>(std::floor(top - y)), 0);
+    int last = std::min(static_cast<int>(std::ceil(top + height - y)), BUNKER_HEIGHT);
+    std::uint64_t bits = spanBits(left, right);
+    if (!bits || first >= last) return -1;
+
+    if (downward) {
+        for (int row = first; row < last; row++) {
+            if (rows[row] & bits) return row;
+        }
+    }
+    else {
+        for (int row = last - 1; row >= first; row--) {
+            if (rows[row] & bits) return row;
+        }
+    }
+    return -1;
+}
+
+void Bunker::erode(float centerX, int row, bool downward) {
+    int shift = static_cast<int>(std::floor(centerX - x)) - STAMP_WIDTH / 2;
+    for (int i = 0; i < STAMP_HEIGHT; i++) {
+        int target = downward ? row - 1 + i : row + 1 - i;
+        if (target < 0 || target >= BUNKER_HEIGHT) continue;
+        std::uint64_t bits = shotStamp[i];
+        bits = shift >= 0 ? bits << shift : bits >> -shift;
+        rows[target] &= ~bits;
+    }
+}
+
+void Bunker::carve(const Rect& rect) {
+    int left = std::max(static_cast<int>(std::floor(rect.left - x)), 0);
+    int right = std::min(static_cast<int>(std::ceil(rect.left + rect.width - x)), BUNKER_WIDTH);
+    int top = std::max(static_cast<int>(std::floor(rect.top - y)), 0);
+    int bottom = std::min(static_cast<int>(std::ceil(rect.top + rect.height - y)), BUNKER_HEIGHT);
+    std::uint64_t bits = ~spanBits(left, right);
+    for (int row = top; row < bottom; row++) {
+        rows[row] &= bits;
+    }
+}
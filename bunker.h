@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include "collision.h"
+
+const int BUNKER_COUNT = 4;
+const int BUNKER_WIDTH = 48;
+const int BUNKER_HEIGHT = 32;
+
+// A destructible shield. Its shape is a packed bitset, one word per row with
+// bit x set while pixel x is still standing, so hit tests and damage are a few
+// word operations per row and no pixel data lives in the simulation.
+struct Bunker {
+    float x = 0.0f;
+    float y = 0.0f;
+    std::uint64_t rows[BUNKER_HEIGHT] = {};
+
+    // Restores the classic arch shape with its top-left corner at (left, top).
+    void reset(float left, float top);
+    Rect bounds() const;
+
+    // First standing row in the column a shot centred on centerX tests,
+    // scanning [top, top + height) in the direction it travels, or -1 when
+    // the column is clear. Only the shot's core is tested, the pixels its
+    // blast stamp always removes, so repeated shots dig through.
+    int firstSolidRow(float centerX, float top, float height, bool downward) const;
+
+    // Blasts an erosion stamp into the shape around (centerX, row); shots
+    // travelling down carve downward, shots from below carve upward.
+    void erode(float centerX, int row, bool downward);
+
+    // Removes everything under the rectangle (an alien walking through).
+    void carve(const Rect& rect);
+};
@@ -0,0 +1,291 @@
+#include "capture.h"
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// SFML's OpenGL header stops at 1.1, so the pixel-buffer and sync entry
+// points (OpenGL 3.2 or ARB_sync) and their constants are looked up here.
+const GLenum CAPTURE_PIXEL_PACK_BUFFER = 0x88EB;
+const GLenum CAPTURE_STREAM_READ = 0x88E1;
+const GLenum CAPTURE_READ_ONLY = 0x88B8;
+const GLenum CAPTURE_SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+const GLbitfield CAPTURE_SYNC_FLUSH_COMMANDS_BIT = 0x1;
+const GLenum CAPTURE_ALREADY_SIGNALED = 0x911A;
+const GLenum CAPTURE_CONDITION_SATISFIED = 0x911C;
+// How long a blocking collect waits for the GPU before dropping the frame.
+const std::uint64_t CAPTURE_FENCE_TIMEOUT_NS = 1000000000;
+
+struct PixelBufferGl {
+    void (APIENTRY* genBuffers)(GLsizei, GLuint*);
+    void (APIENTRY* deleteBuffers)(GLsizei, const GLuint*);
+    void (APIENTRY* bindBuffer)(GLenum, GLuint);
+    void (APIENTRY* bufferData)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    void* (APIENTRY* mapBuffer)(GLenum, GLenum);
+    GLboolean (APIENTRY* unmapBuffer)(GLenum);
+    void* (APIENTRY* fenceSync)(GLenum, GLbitfield);
+    GLenum (APIENTRY* clientWaitSync)(void*, GLbitfield, std::uint64_t);
+    void (APIENTRY* deleteSync)(void*);
+};
+
+static PixelBufferGl gl;
+
+template <class Function>
+static bool loadGlFunction(Function& function, const char* name) {
+    function = reinterpret_cast<Function>(sf::Context::getFunction(name));
+    return function != nullptr;
+}
+
+// Needs an active context.
+static bool loadPixelBufferGl() {
+    return loadGlFunction(gl.genBuffers, "glGenBuffers")
+        && loadGlFunction(gl.deleteBuffers, "glDeleteBuffers")
+        && loadGlFunction(gl.bindBuffer, "glBindBuffer")
+        && loadGlFunction(gl.bufferData, "glBufferData")
+        && loadGlFunction(gl.mapBuffer, "glMapBuffer")
+        && loadGlFunction(gl.unmapBuffer, "glUnmapBuffer")
+        && loadGlFunction(gl.fenceSync, "glFenceSync")
+        && loadGlFunction(gl.clientWaitSync, "glClientWaitSync")
+        && loadGlFunction(gl.deleteSync, "glDeleteSync");
+}
+
+FrameCapture::~FrameCapture() {
+    stop();
+}
+
+bool FrameCapture::start(const std::string& outputPath, unsigned frameWidth, unsigned frameHeight, int rate) {
+    path = outputPath;
+    width = frameWidth & ~1u;
+    height = frameHeight & ~1u;
+    framesPerSecond = std::max(1, rate);
+    bool y4m = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+    format = y4m ? CAPTURE_Y4M : CAPTURE_PNG;
+
+    if (width == 0 || height == 0 || !target.create(width, height)) return false;
+    buffers.assign(frameBytes() * CAPTURE_BUFFERS, 0);
+
+    pixelBuffersReady = false;
+    issued = 0;
+    collected = 0;
+    if (target.setActive(true)) {
+        if (loadPixelBufferGl()) {
+            gl.genBuffers(CAPTURE_READBACKS, pixelBuffers);
+            for (int i = 0; i < CAPTURE_READBACKS; i++) {
+                gl.bindBuffer(CAPTURE_PIXEL_PACK_BUFFER, pixelBuffers[i]);
+                gl.bufferData(CAPTURE_PIXEL_PACK_BUFFER, static_cast<std::ptrdiff_t>(frameBytes()), nullptr, CAPTURE_STREAM_READ);
+                fences[i] = nullptr;
+            }
+            gl.bindBuffer(CAPTURE_PIXEL_PACK_BUFFER, 0);
+            pixelBuffersReady = true;
+        }
+        target.setActive(false);
+    }
+
+    written = 0;
+    encoded = 0;
+    failed = false;
+    running = true;
+    worker = std::thread(&FrameCapture::run, this);
+    return true;
+}
+
+// The ring buffer for the next frame, or null if the frame is dropped
+// because the encoder is behind.
+std::uint8_t* FrameCapture::reserve(bool waitForSpace) {
+    std::uint64_t frame = written.load(std::memory_order_relaxed);
+    while (frame - encoded.load(std::memory_order_acquire) >= CAPTURE_BUFFERS) {
+        if (!waitForSpace || failed) {
+            dropped++;
+            return nullptr;
+        }
+        std::this_thread::yield();
+    }
+    return &buffers[(frame % CAPTURE_BUFFERS) * frameBytes()];
+}
+
+void FrameCapture::publish() {
+    written.store(written.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    wake.notify_one();
+}
+
+// Copies the oldest readback in flight into the ring. Without wait it
+// returns false if the GPU has not finished it yet; with wait a readback
+// that does not finish within CAPTURE_FENCE_TIMEOUT_NS is dropped.
+bool FrameCapture::collect(bool wait, bool waitForSpace) {
+    int slot = static_cast<int>(collected % CAPTURE_READBACKS);
+    bool done = true;
+    if (fences[slot]) {
+        GLenum status = gl.clientWaitSync(fences[slot], CAPTURE_SYNC_FLUSH_COMMANDS_BIT, wait ? CAPTURE_FENCE_TIMEOUT_NS : 0);
+        done = status == CAPTURE_ALREADY_SIGNALED || status == CAPTURE_CONDITION_SATISFIED;
+        if (!done && !wait) return false;
+        gl.deleteSync(fences[slot]);
+        fences[slot] = nullptr;
+    }
+    collected++;
+
+    std::uint8_t* pixels = done ? reserve(waitForSpace) : nullptr;
+    if (!done) dropped++;
+    if (!pixels) return true;
+
+    gl.bindBuffer(CAPTURE_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+    if (const void* mapped = gl.mapBuffer(CAPTURE_PIXEL_PACK_BUFFER, CAPTURE_READ_ONLY)) {
+        std::memcpy(pixels, mapped, frameBytes());
+        gl.unmapBuffer(CAPTURE_PIXEL_PACK_BUFFER);
+        publish();
+    }
+    else {
+        dropped++;
+    }
+    gl.bindBuffer(CAPTURE_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void FrameCapture::grab(bool waitForSpace) {
+    if (!running) return;
+
+    // Waiting for space is the encoder's cost, but it is part of what the
+    // game loop pays, so it is counted.
+    auto begin = std::chrono::steady_clock::now();
+    if (target.setActive(true)) {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        if (pixelBuffersReady) {
+            while (collected < issued && collect(false, waitForSpace)) {}
+            // Every buffer still rendering: the oldest is CAPTURE_READBACKS
+            // frames old and nearly always done, so waiting for it is short.
+            if (issued - collected == CAPTURE_READBACKS) collect(true, waitForSpace);
+
+            int slot = static_cast<int>(issued % CAPTURE_READBACKS);
+            gl.bindBuffer(CAPTURE_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+            glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            gl.bindBuffer(CAPTURE_PIXEL_PACK_BUFFER, 0);
+            fences[slot] = gl.fenceSync(CAPTURE_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            issued++;
+        }
+        else if (std::uint8_t* pixels = reserve(waitForSpace)) {
+            glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            publish();
+        }
+        target.setActive(false);
+    }
+    else {
+        dropped++;
+    }
+
+    std::uint32_t micros = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+    overheadTotal += micros;
+    overheadWorst = std::max(overheadWorst, micros);
+}
+
+void FrameCapture::stop() {
+    if (!worker.joinable()) return;
+
+    // The last frames are still on the GPU; they go to the encoder before it
+    // is told to finish.
+    if (pixelBuffersReady && target.setActive(true)) {
+        while (collected < issued) collect(true, true);
+        gl.deleteBuffers(CAPTURE_READBACKS, pixelBuffers);
+        target.setActive(false);
+    }
+    pixelBuffersReady = false;
+
+    running = false;
+    wake.notify_one();
+    worker.join();
+}
+
+void FrameCapture::report() const {
+    std::uint64_t frames = written.load();
+    std::uint64_t grabs = frames + dropped;
+    std::fprintf(stderr, "Captured %llu frames to %s, dropped %llu; %s readback, grab() %.1f us mean, %.1f us worst%s\n",
+        static_cast<unsigned long long>(frames), path.c_str(), static_cast<unsigned long long>(dropped),
+        issued > 0 ? "asynchronous" : "synchronous",
+        grabs ? static_cast<double>(overheadTotal) / grabs : 0.0, static_cast<double>(overheadWorst), failed ? " (write FAILED)" : "");
+}
+
+// BT.601 full range, the "C420jpeg" colour space, with chroma averaged over
+// each 2x2 block. Rows arrive bottom-up from glReadPixels.
+static void writeY4mFrame(std::ofstream& file, const std::uint8_t* rgba, unsigned width, unsigned height, std::vector<std::uint8_t>& planes) {
+    std::size_t lumaSize = static_cast<std::size_t>(width) * height;
+    std::size_t chromaSize = lumaSize / 4;
+    planes.resize(lumaSize + chromaSize * 2);
+    std::uint8_t* luma = planes.data();
+    std::uint8_t* cb = luma + lumaSize;
+    std::uint8_t* cr = cb + chromaSize;
+
+    for (unsigned y = 0; y < height; y++) {
+        const std::uint8_t* row = rgba + static_cast<std::size_t>(height - 1 - y) * width * 4;
+        for (unsigned x = 0; x < width; x++) {
+            const std::uint8_t* p = row + x * 4;
+            luma[y * width + x] = static_cast<std::uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+    for (unsigned y = 0; y < height; y += 2) {
+        const std::uint8_t* row0 = rgba + static_cast<std::size_t>(height - 1 - y) * width * 4;
+        const std::uint8_t* row1 = row0 - static_cast<std::size_t>(width) * 4;
+        for (unsigned x = 0; x < width; x += 2) {
+            int r = row0[x * 4] + row0[x * 4 + 4] + row1[x * 4] + row1[x * 4 + 4];
+            int g = row0[x * 4 + 1] + row0[x * 4 + 5] + row1[x * 4 + 1] + row1[x * 4 + 5];
+            int b = row0[x * 4 + 2] + row0[x * 4 + 6] + row1[x * 4 + 2] + row1[x * 4 + 6];
+            std::size_t index = (y / 2) * (width / 2) + x / 2;
+            cb[index] = static_cast<std::uint8_t>(std::min(255, std::max(0, (-43 * r - 85 * g + 128 * b + 512) / 1024 + 128)));
+            cr[index] = static_cast<std::uint8_t>(std::min(255, std::max(0, (128 * r - 107 * g - 21 * b + 512) / 1024 + 128)));
+        }
+    }
+
+    file << "FRAME\n";
+    file.write(reinterpret_cast<const char*>(planes.data()), planes.size());
+}
+
+static bool writePng(const std::string& path, std::uint64_t frame, const std::uint8_t* rgba, unsigned width, unsigned height, std::vector<std::uint8_t>& flipped) {
+    std::size_t stride = static_cast<std::size_t>(width) * 4;
+    flipped.resize(stride * height);
+    for (unsigned y = 0; y < height; y++) {
+        std::copy(rgba + (height - 1 - y) * stride, rgba + (height - y) * stride, flipped.begin() + y * stride);
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "_%06llu.png", static_cast<unsigned long long>(frame));
+    sf::Image image;
+    image.create(width, height, flipped.data());
+    return image.saveToFile(path + name);
+}
+
+void FrameCapture::run() {
+    std::ofstream file;
+    if (format == CAPTURE_Y4M) {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        file << "YUV4MPEG2 W" << width << " H" << height << " F" << framesPerSecond << ":1 Ip A1:1 C420jpeg\n";
+        if (!file) failed = true;
+    }
+    std::vector<std::uint8_t> scratch;
+
+    for (;;) {
+        // Read before the ring: once stop() is seen, every frame published
+        // before it is visible too, so the queue drains completely.
+        bool stopping = !running;
+        std::uint64_t frame = encoded.load(std::memory_order_relaxed);
+        if (frame == written.load(std::memory_order_acquire)) {
+            if (stopping) break;
+            // The producer notifies without the lock, so a wake-up can be
+            // missed; the timeout bounds how long that delays a frame.
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(5));
+            continue;
+        }
+
+        const std::uint8_t* pixels = &buffers[(frame % CAPTURE_BUFFERS) * frameBytes()];
+        if (!failed) {
+            if (format == CAPTURE_Y4M) {
+                writeY4mFrame(file, pixels, width, height, scratch);
+                if (!file) failed = true;
+            }
+            else if (!writePng(path, frame, pixels, width, height, scratch)) {
+                failed = true;
+            }
+        }
+        encoded.store(frame + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frames that may wait for the encoder before new ones are dropped.
+const int CAPTURE_BUFFERS = 8;
+// Readbacks in flight on the GPU; a frame reaches the encoder this many
+// grabs minus one after it was drawn.
+const int CAPTURE_READBACKS = 3;
+
+enum CaptureFormat {
+    CAPTURE_PNG,
+    CAPTURE_Y4M,
+};
+
+// Records rendered frames with the encoding and disk writes moved off the
+// game loop. Frames are drawn into target; grab() reads the pixels back into
+// the next free buffer of a fixed ring and a worker thread encodes them to a
+// PNG sequence (path_000000.png, ...) or one raw Y4M stream (path ending in
+// .y4m). When the worker falls behind and the ring is full, the frame is
+// dropped and counted instead of waiting.
+//
+// The readback is asynchronous: grab() has the GPU copy the frame into a
+// pixel-buffer object behind a fence and returns, and a later grab() copies
+// out the ones whose fence has signalled, so the game loop does not wait for
+// the frame to finish rendering. Without pixel-buffer objects and fences
+// (OpenGL 3.2 or ARB_sync) it falls back to a synchronous glReadPixels.
+// report() prints what grab() cost. Link OpenGL (opengl32 or GL) as well.
+struct FrameCapture {
+    sf::RenderTexture target;
+    CaptureFormat format = CAPTURE_PNG;
+    std::string path;
+    unsigned width = 0;
+    unsigned height = 0;
+    int framesPerSecond = 60;
+
+    std::vector<std::uint8_t> buffers;
+    std::atomic<std::uint64_t> written{ 0 };
+    std::atomic<std::uint64_t> encoded{ 0 };
+    std::atomic<bool> running{ false };
+    std::atomic<bool> failed{ false };
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::thread worker;
+
+    // Pixel-buffer objects and their fences, used round-robin; issued and
+    // collected count the readbacks started and copied out.
+    bool pixelBuffersReady = false;
+    unsigned pixelBuffers[CAPTURE_READBACKS] = {};
+    void* fences[CAPTURE_READBACKS] = {};
+    std::uint64_t issued = 0;
+    std::uint64_t collected = 0;
+
+    std::uint64_t dropped = 0;
+    std::uint64_t overheadTotal = 0;
+    std::uint32_t overheadWorst = 0;
+
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    ~FrameCapture();
+
+    bool start(const std::string& outputPath, unsigned frameWidth, unsigned frameHeight, int rate);
+    // Call after target.display(), on the thread that draws into target.
+    // Blocks neither for the GPU nor the encoder unless CAPTURE_READBACKS
+    // frames are still rendering. With waitForSpace the frame is never
+    // dropped; headless capture uses it since nothing runs in real time.
+    void grab(bool waitForSpace = false);
+    // Collects the readbacks still in flight, encodes the frames still
+    // queued and joins the worker. Call it from the thread that grabs.
+    void stop();
+    void report() const;
+
+private:
+    std::size_t frameBytes() const { return static_cast<std::size_t>(width) * height * 4; }
+    std::uint8_t* reserve(bool waitForSpace);
+    void publish();
+    bool collect(bool wait, bool waitForSpace);
+    void run();
+};
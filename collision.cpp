@@ -0,0 +1,99 @@
+#include "collision.h"
+#include "formation.h"
+#include <algorithm>
+#include <cmath>
+
+bool intersects(const Rect& a, const Rect& b) {
+    return a.left < b.left + b.width && b.left < a.left + a.width &&
+        a.top < b.top + b.height && b.top < a.top + a.height;
+}
+
+CollisionMask maskFromPixels(const std::uint8_t* rgba, int imageWidth, int left, int top, int width, int height, std::uint8_t alphaThreshold) {
+    CollisionMask mask;
+    mask.width = std::min(width, 64);
+    mask.height = height;
+    mask.rows.assign(height, 0);
+    for (int y = 0; y < height; y++) {
+        const std::uint8_t* row = rgba + (static_cast<std::size_t>(top + y) * imageWidth + left) * 4;
+        for (int x = 0; x < mask.width; x++) {
+            if (row[x * 4 + 3] >= alphaThreshold) {
+                mask.rows[y] |= std::uint64_t(1) << x;
+            }
+        }
+    }
+    return mask;
+}
+
+bool maskOverlapsRect(const CollisionMask& mask, float x, float y, const Rect& rect) {
+    int left = std::max(static_cast<int>(std::floor(rect.left - x)), 0);
+    int right = std::min(static_cast<int>(std::ceil(rect.left + rect.width - x)), mask.width);
+    int top = std::max(static_cast<int>(std::floor(rect.top - y)), 0);
+    int bottom = std::min(static_cast<int>(std::ceil(rect.top + rect.height - y)), mask.height);
+    if (left >= right || top >= bottom) return false;
+
+    int span = right - left;
+    std::uint64_t bits = (span == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << span) - 1) << left;
+    for (int row = top; row < bottom; row++) {
+        if (mask.rows[row] & bits) return true;
+    }
+    return false;
+}
+
+int queryFormation(const Formation& formation, const Rect& rect, float alienSize, const CollisionMask* mask) {
+    if (formation.livingCount == 0) return -1;
+
+    // Slot 0 moves with everything else, so it carries the shared offset even
+    // after it has been shot.
+    float originX = formation.x[0];
+    float originY = formation.y[0];
+    float spacing = formation.spacing;
+
+    int column0 = static_cast<int>(std::floor((rect.left - originX - alienSize) / spacing)) + 1;
+    int column1 = static_cast<int>(std::floor((rect.left + rect.width - originX) / spacing));
+    int row0 = static_cast<int>(std::floor((rect.top - originY - alienSize) / spacing)) + 1;
+    int row1 = static_cast<int>(std::floor((rect.top + rect.height - originY) / spacing));
+
+    column0 = std::max(column0, formation.leftColumn);
+    column1 = std::min(column1, formation.rightColumn);
+    row0 = std::max(row0, 0);
+    row1 = std::min(row1, formation.bottomRow);
+
+    for (int row = row1; row >= row0; row--) {
+        for (int column = column0; column <= column1; column++) {
+            int slot = formation.slot(row, column);
+            if (!formation.isAlive(slot)) continue;
+            Rect alien = { formation.x[slot], formation.y[slot], alienSize, alienSize };
+            if (intersects(rect, alien) && (!mask || maskOverlapsRect(*mask, alien.left, alien.top, rect))) {
+                return slot;
+            }
+        }
+    }
+    return -1;
+}
+
+void UniformGrid::reset(float width, float height, float size) {
+    cellSize = size;
+    columns = std::max(1, static_cast<int>(std::ceil(width / size)));
+    rows = std::max(1, static_cast<int>(std::ceil(height / size)));
+    cellStart.reserve(columns * rows + 1);
+    cellFill.reserve(columns * rows + 1);
+}
+
+void UniformGrid::reserve(int items) {
+    rects.reserve(items);
+    visited.reserve(items);
+    // An item no larger than a cell overlaps at most four of them.
+    entries.reserve(items * 4);
+}
+
+void UniformGrid::cellRange(const Rect& rect, int& column0, int& row0, int& column1, int& row1) const {
+    column0 = static_cast<int>(std::floor(rect.left / cellSize));
+    row0 = static_cast<int>(std::floor(rect.top / cellSize));
+    column1 = static_cast<int>(std::floor((rect.left + rect.width) / cellSize));
+    row1 = static_cast<int>(std::floor((rect.top + rect.height) / cellSize));
+
+    column0 = std::min(std::max(column0, 0), columns - 1);
+    column1 = std::min(std::max(column1, 0), columns - 1);
+    row0 = std::min(std::max(row0, 0), rows - 1);
+    row1 = std::min(std::max(row1, 0), rows - 1);
+}
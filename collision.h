@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct Formation;
+
+struct Rect {
+    float left, top, width, height;
+};
+
+bool intersects(const Rect& a, const Rect& b);
+
+// 1-bit coverage of one sprite frame, one word per row with bit x set when
+// pixel x is solid. Frames are at most 64 pixels wide.
+struct CollisionMask {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint64_t> rows;
+};
+
+// Per-frame masks for the sprites that can be hit, indexed like the
+// renderer's frame lists. A Simulation without masks tests rectangles only.
+struct SpriteMasks {
+    std::vector<CollisionMask> alien;
+    std::vector<CollisionMask> ship;
+};
+
+// Builds a mask from the frame at (left, top) in an RGBA8 image, marking the
+// pixels whose alpha reaches the threshold.
+CollisionMask maskFromPixels(const std::uint8_t* rgba, int imageWidth, int left, int top, int width, int height, std::uint8_t alphaThreshold = 128);
+
+// Narrow phase for a solid rectangle against a mask drawn at (x, y): one AND
+// of a shifted span per overlapping row. Call it only after the rectangles
+// intersect.
+bool maskOverlapsRect(const CollisionMask& mask, float x, float y, const Rect& rect);
+
+// Narrow query against the formation grid. Maps the rectangle into formation
+// cell coordinates and tests only the living aliens in the cells it can
+// touch, bottom row first. With a mask, an alien only counts as hit where the
+// mask is solid. Returns the slot that was hit, or -1.
+int queryFormation(const Formation& formation, const Rect& rect, float alienSize, const CollisionMask* mask = nullptr);
+
+// Broadphase for free-moving entities. build() buckets entity rectangles into
+// fixed-size cells; query() visits each entity whose cells overlap a rectangle
+// once and stops early when the visitor returns true. Storage is kept between
+// builds.
+struct UniformGrid {
+    float cellSize = 64.0f;
+    int columns = 0;
+    int rows = 0;
+    std::vector<int> cellStart;
+    std::vector<int> cellFill;
+    std::vector<int> entries;
+    std::vector<Rect> rects;
+    std::vector<unsigned> visited;
+    unsigned queryStamp = 0;
+
+    void reset(float width, float height, float size);
+    // Sizes the item buffers up front so build() never grows them.
+    void reserve(int items);
+    void cellRange(const Rect& rect, int& column0, int& row0, int& column1, int& row1) const;
+
+    template <class GetRect>
+    void build(int count, GetRect rectOf) {
+        int cells = columns * rows;
+        rects.resize(count);
+        visited.assign(count, 0);
+        queryStamp = 0;
+        cellStart.assign(cells + 1, 0);
+
+        for (int i = 0; i < count; i++) {
+            rects[i] = rectOf(i);
+            int c0, r0, c1, r1;
+            cellRange(rects[i], c0, r0, c1, r1);
+            for (int r = r0; r <= r1; r++) {
+                for (int c = c0; c <= c1; c++) {
+                    cellStart[r * columns + c + 1]++;
+                }
+            }
+        }
+        for (int cell = 0; cell < cells; cell++) {
+            cellStart[cell + 1] += cellStart[cell];
+        }
+
+        entries.resize(cellStart[cells]);
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; i++) {
+            int c0, r0, c1, r1;
+            cellRange(rects[i], c0, r0, c1, r1);
+            for (int r = r0; r <= r1; r++) {
+                for (int c = c0; c <= c1; c++) {
+                    entries[cellFill[r * columns + c]++] = i;
+                }
+            }
+        }
+    }
+
+    template <class Visit>
+    bool query(const Rect& rect, Visit visit) {
+        if (rects.empty()) return false;
+        queryStamp++;
+        int c0, r0, c1, r1;
+        cellRange(rect, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                int cell = r * columns + c;
+                for (int e = cellStart[cell]; e < cellStart[cell + 1]; e++) {
+                    int id = entries[e];
+                    if (visited[id] == queryStamp) continue;
+                    visited[id] = queryStamp;
+                    if (intersects(rect, rects[id]) && visit(id)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,129 @@
+#include "formation.h"
+#include <algorithm>
+
+void Formation::reset(int rowCount, int columnCount, float originX, float originY, float slotSpacing, std::uint32_t tick) {
+    rows = rowCount;
+    columns = columnCount;
+    spacing = slotSpacing;
+
+    int count = size();
+    int words = (count + 63) / 64;
+    x.resize(count);
+    y.resize(count);
+    deathFrame.assign(count, 0);
+    deathTick.assign(count, 0);
+    alive.assign(words, 0);
+    dying.assign(words, 0);
+    rowCounts.assign(rows, columns);
+    columnCounts.assign(columns, rows);
+    lowestRow.assign(columns, rows - 1);
+    shooterColumns.resize(rows > 0 ? columns : 0);
+    shooterPosition.resize(columns);
+    for (int j = 0; j < columns; j++) {
+        if (rows > 0) shooterColumns[j] = j;
+        shooterPosition[j] = rows > 0 ? j : -1;
+    }
+
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < columns; j++) {
+            x[slot(i, j)] = originX + j * spacing;
+            y[slot(i, j)] = originY + i * spacing;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        alive[i >> 6] |= std::uint64_t(1) << (i & 63);
+    }
+
+    livingCount = count;
+    dyingCount = 0;
+    leftColumn = count > 0 ? 0 : -1;
+    rightColumn = count > 0 ? columns - 1 : -1;
+    bottomRow = count > 0 ? rows - 1 : -1;
+    walkFrame = 0;
+    walkTick = tick;
+}
+
+void Formation::recount() {
+    rowCounts.assign(rows, 0);
+    columnCounts.assign(columns, 0);
+    lowestRow.assign(columns, -1);
+    livingCount = 0;
+    dyingCount = 0;
+
+    int count = size();
+    for (int i = 0; i < count; i++) {
+        if (isDying(i)) dyingCount++;
+        if (!isAlive(i)) continue;
+        int row = i / columns;
+        int column = i % columns;
+        rowCounts[row]++;
+        columnCounts[column]++;
+        lowestRow[column] = std::max(lowestRow[column], row);
+        livingCount++;
+    }
+
+    shooterPosition.assign(columns, -1);
+    for (int i = 0; i < shooterCount(); i++) {
+        shooterPosition[shooterColumns[i]] = i;
+    }
+
+    leftColumn = rightColumn = bottomRow = -1;
+    if (livingCount == 0) return;
+    leftColumn = 0;
+    rightColumn = columns - 1;
+    bottomRow = rows - 1;
+    while (columnCounts[leftColumn] == 0) leftColumn++;
+    while (columnCounts[rightColumn] == 0) rightColumn--;
+    while (rowCounts[bottomRow] == 0) bottomRow--;
+}
+
+void Formation::translate(float dx, float dy) {
+    float* px = x.data();
+    float* py = y.data();
+    int count = size();
+    for (int i = 0; i < count; i++) {
+        px[i] += dx;
+        py[i] += dy;
+    }
+}
+
+void Formation::kill(int slot, std::uint32_t tick) {
+    alive[slot >> 6] &= ~(std::uint64_t(1) << (slot & 63));
+    dying[slot >> 6] |= std::uint64_t(1) << (slot & 63);
+    deathFrame[slot] = 0;
+    deathTick[slot] = tick;
+    livingCount--;
+    dyingCount++;
+
+    int row = slot / columns;
+    int column = slot % columns;
+    rowCounts[row]--;
+    columnCounts[column]--;
+
+    if (lowestRow[column] == row) {
+        int above = row - 1;
+        while (above >= 0 && !isAlive(this->slot(above, column))) above--;
+        lowestRow[column] = above;
+        if (above < 0) {
+            int hole = shooterPosition[column];
+            int last = shooterColumns.back();
+            shooterColumns[hole] = last;
+            shooterPosition[last] = hole;
+            shooterColumns.pop_back();
+            shooterPosition[column] = -1;
+        }
+    }
+
+    if (livingCount == 0) {
+        leftColumn = rightColumn = bottomRow = -1;
+        return;
+    }
+    while (columnCounts[leftColumn] == 0) leftColumn++;
+    while (columnCounts[rightColumn] == 0) rightColumn--;
+    while (rowCounts[bottomRow] == 0) bottomRow--;
+}
+
+void Formation::remove(int slot) {
+    dying[slot >> 6] &= ~(std::uint64_t(1) << (slot & 63));
+    dyingCount--;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline int lowestSetBit(std::uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// The alien formation stored as flat per-slot arrays, slot = row * columns + column.
+// A slot is "alive" while it still takes part in the formation, "dying" while its
+// death animation plays, and empty once both bits are clear. Every slot moves with
+// the formation, so movement is one straight pass over x and y.
+struct Formation {
+    int rows = 0;
+    int columns = 0;
+    float spacing = 0.0f;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<std::uint64_t> alive;
+    std::vector<std::uint64_t> dying;
+    std::vector<std::uint8_t> deathFrame;
+    std::vector<std::uint32_t> deathTick;
+
+    // Living aliens per row and column, so the formation edges are known
+    // without looking at every slot.
+    std::vector<int> rowCounts;
+    std::vector<int> columnCounts;
+    // Lowest living row in each column (-1 once the column is empty) and the
+    // dense list of columns that still have a shooter, so picking a shooter
+    // is O(1).
+    std::vector<int> lowestRow;
+    std::vector<int> shooterColumns;
+    std::vector<int> shooterPosition;
+
+    int livingCount = 0;
+    int dyingCount = 0;
+    int leftColumn = -1;
+    int rightColumn = -1;
+    int bottomRow = -1;
+
+    // Living aliens animate in lockstep, so the walk cycle is shared.
+    int walkFrame = 0;
+    std::uint32_t walkTick = 0;
+
+    void reset(int rowCount, int columnCount, float originX, float originY, float slotSpacing, std::uint32_t tick);
+
+    int size() const { return rows * columns; }
+    int slot(int row, int column) const { return row * columns + column; }
+    bool isAlive(int slot) const { return (alive[slot >> 6] >> (slot & 63)) & 1; }
+    bool isDying(int slot) const { return (dying[slot >> 6] >> (slot & 63)) & 1; }
+    bool empty() const { return livingCount == 0 && dyingCount == 0; }
+
+    // Living edges in world space; only meaningful while livingCount > 0.
+    float leftEdge() const { return x[leftColumn]; }
+    float rightEdge() const { return x[rightColumn]; }
+    float bottomEdge() const { return y[slot(bottomRow, 0)]; }
+
+    int shooterCount() const { return static_cast<int>(shooterColumns.size()); }
+    int shooterSlot(int index) const { return slot(lowestRow[shooterColumns[index]], shooterColumns[index]); }
+
+    // Rebuilds the counts, edges, lowest rows and shooter positions from the
+    // alive and dying bits and the current shooterColumns order, after the
+    // primary arrays were written directly (loading a snapshot).
+    void recount();
+
+    void translate(float dx, float dy);
+    void kill(int slot, std::uint32_t tick);
+    void remove(int slot);
+};
+
+// Calls f(slot) for every slot whose bit is set in either mask.
+template <class F>
+void forEachSlot(const std::vector<std::uint64_t>& a, const std::vector<std::uint64_t>& b, F f) {
+    for (std::size_t i = 0; i < a.size(); i++) {
+        std::uint64_t word = a[i] | b[i];
+        while (word) {
+            f(static_cast<int>(i * 64) + lowestSetBit(word));
+            word &= word - 1;
+        }
+    }
+}
+
+template <class F>
+void forEachSlot(const std::vector<std::uint64_t>& mask, F f) {
+    for (std::size_t i = 0; i < mask.size(); i++) {
+        std::uint64_t word = mask[i];
+        while (word) {
+            f(static_cast<int>(i * 64) + lowestSetBit(word));
+            word &= word - 1;
+        }
+    }
+}
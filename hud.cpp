@@ -0,0 +1,108 @@
+#include "hud.h"
+#include <algorithm>
+#include <cmath>
+
+bool GlyphAtlas::bake(const sf::Font& font, unsigned size) {
+    characterSize = size;
+    digitAdvance = 0.0f;
+    for (const char* c = HUD_CHARACTERS; *c; c++) {
+        const sf::Glyph& glyph = font.getGlyph(static_cast<unsigned char>(*c), size, false);
+        Glyph& baked = glyphs[static_cast<unsigned char>(*c)];
+        baked.rect = glyph.textureRect;
+        baked.left = glyph.bounds.left;
+        baked.top = glyph.bounds.top;
+        baked.advance = glyph.advance;
+        if (*c >= '0' && *c <= '9') digitAdvance = std::max(digitAdvance, glyph.advance);
+    }
+    // Every glyph the HUD needs is now on the font's page; a private copy
+    // cannot be resized or repacked by text drawn elsewhere.
+    return texture.loadFromImage(font.getTexture(size).copyToImage());
+}
+
+float GlyphAtlas::addText(SpriteBatch& batch, float x, float y, const char* text, const sf::Color& color) const {
+    float baseline = y + characterSize;
+    for (const char* c = text; *c; c++) {
+        const Glyph& glyph = glyphs[static_cast<unsigned char>(*c) & 127];
+        bool digit = *c >= '0' && *c <= '9';
+        float cell = digit ? digitAdvance : glyph.advance;
+        float offset = digit ? std::floor((digitAdvance - glyph.advance) / 2) : 0.0f;
+        if (glyph.rect.width > 0) {
+            batch.addSprite(x + offset + glyph.left, baseline + glyph.top, glyph.rect, color);
+        }
+        x += cell;
+    }
+    return x;
+}
+
+const char* formatNumber(int value, char (&digits)[HUD_NUMBER_LENGTH]) {
+    char* start = digits + HUD_NUMBER_LENGTH - 1;
+    *start = '\0';
+    unsigned magnitude = value < 0 ? 0u - static_cast<unsigned>(value) : static_cast<unsigned>(value);
+    do {
+        *--start = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) *--start = '-';
+    return start;
+}
+
+float GlyphAtlas::addNumber(SpriteBatch& batch, float x, float y, int value, const sf::Color& color) const {
+    char digits[HUD_NUMBER_LENGTH];
+    return addText(batch, x, y, formatNumber(value, digits), color);
+}
+
+Hud::Hud(const sf::Font& font) : batch(&atlas.texture) {
+    atlas.bake(font, HUD_CHARACTER_SIZE);
+}
+
+void Hud::update(const Simulation& sim) {
+    if (sim.lives != lives || sim.wave != wave || sim.score != score) {
+        lives = sim.lives;
+        wave = sim.wave;
+        score = sim.score;
+        dirty = true;
+    }
+}
+
+void Hud::frameTime(float seconds) {
+    statsTime += seconds;
+    statsFrames++;
+    if (statsTime < HUD_STATS_INTERVAL) return;
+
+    int fps = static_cast<int>(statsFrames / statsTime + 0.5f);
+    int tenths = static_cast<int>(statsTime * 10000.0f / statsFrames + 0.5f);
+    if (showStats && (fps != framesPerSecond || tenths != frameTenths)) dirty = true;
+    framesPerSecond = fps;
+    frameTenths = tenths;
+    statsTime = 0.0f;
+    statsFrames = 0;
+}
+
+void Hud::toggleStats() {
+    showStats = !showStats;
+    dirty = true;
+}
+
+void Hud::rebuild() {
+    const sf::Color color = sf::Color::Yellow;
+    batch.begin();
+
+    atlas.addNumber(batch, atlas.addText(batch, 20, 20, "Wave: ", color), 20, wave, color);
+    atlas.addNumber(batch, atlas.addText(batch, 320, 20, "Score: ", color), 20, score, color);
+    atlas.addNumber(batch, atlas.addText(batch, 700, 20, "Lives: ", color), 20, lives, color);
+
+    if (showStats) {
+        float x = atlas.addNumber(batch, 20, 46, framesPerSecond, color);
+        x = atlas.addText(batch, x, 46, " fps  ", color);
+        x = atlas.addNumber(batch, x, 46, frameTenths / 10, color);
+        x = atlas.addText(batch, x, 46, ".", color);
+        x = atlas.addNumber(batch, x, 46, frameTenths % 10, color);
+        atlas.addText(batch, x, 46, " ms", color);
+    }
+    dirty = false;
+}
+
+void Hud::draw(sf::RenderTarget& target) {
+    if (dirty) rebuild();
+    batch.draw(target);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "batch.h"
+#include "simulation.h"
+
+// The only characters the HUD can print.
+const char* const HUD_CHARACTERS = " -0123456789.:ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+const unsigned HUD_CHARACTER_SIZE = 20;
+// How often the frame-rate readout changes; any faster and nobody can read it.
+const float HUD_STATS_INTERVAL = 0.25f;
+// Room for any int in decimal, sign and terminator included.
+const int HUD_NUMBER_LENGTH = 12;
+
+// Writes value in decimal into the end of digits and returns where it starts.
+const char* formatNumber(int value, char (&digits)[HUD_NUMBER_LENGTH]);
+
+// One font size rasterised once into a texture of its own. Digits share the
+// widest digit's advance, so a changing number never shifts the text after it.
+struct GlyphAtlas {
+    struct Glyph {
+        sf::IntRect rect;
+        float left = 0.0f;
+        float top = 0.0f;
+        float advance = 0.0f;
+    };
+
+    sf::Texture texture;
+    Glyph glyphs[128];
+    float digitAdvance = 0.0f;
+    unsigned characterSize = 0;
+
+    bool bake(const sf::Font& font, unsigned size);
+    // Appends text with its top-left corner at (x, y), the way sf::Text lays
+    // it out; returns the pen position after the last character.
+    float addText(SpriteBatch& batch, float x, float y, const char* text, const sf::Color& color) const;
+    float addNumber(SpriteBatch& batch, float x, float y, int value, const sf::Color& color) const;
+};
+
+// Lives, wave, score and an optional frame-rate readout in one vertex batch.
+// update() compares the values with the ones on screen, and the batch is only
+// rebuilt when one of them changed.
+struct Hud {
+    GlyphAtlas atlas;
+    SpriteBatch batch;
+    int lives = -1;
+    int wave = -1;
+    int score = -1;
+    bool dirty = true;
+
+    bool showStats = false;
+    float statsTime = 0.0f;
+    int statsFrames = 0;
+    int framesPerSecond = 0;
+    // Average frame time over the last interval, in tenths of a millisecond.
+    int frameTenths = 0;
+
+    explicit Hud(const sf::Font& font);
+
+    void update(const Simulation& sim);
+    void frameTime(float seconds);
+    void toggleStats();
+    void draw(sf::RenderTarget& target);
+
+private:
+    void rebuild();
+};
@@ -0,0 +1,189 @@
+#include "input.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static const char* const actionNames[ACTION_COUNT] = {
+    "up",
+    "down",
+    "left",
+    "right",
+    "fire",
+    "start",
+    "pause",
+};
+
+static const struct {
+    const char* name;
+    sf::Keyboard::Key key;
+} namedKeys[] = {
+    { "Space", sf::Keyboard::Space },
+    { "Enter", sf::Keyboard::Enter },
+    { "Tab", sf::Keyboard::Tab },
+    { "Up", sf::Keyboard::Up },
+    { "Down", sf::Keyboard::Down },
+    { "Left", sf::Keyboard::Left },
+    { "Right", sf::Keyboard::Right },
+    { "LShift", sf::Keyboard::LShift },
+    { "LControl", sf::Keyboard::LControl },
+};
+
+static sf::Keyboard::Key keyFromName(const std::string& name) {
+    if (name.size() == 1 && name[0] >= 'A' && name[0] <= 'Z') {
+        return static_cast<sf::Keyboard::Key>(sf::Keyboard::A + (name[0] - 'A'));
+    }
+    for (const auto& named : namedKeys) {
+        if (name == named.name) return named.key;
+    }
+    return sf::Keyboard::Unknown;
+}
+
+KeyBindings::KeyBindings() {
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        for (int j = 0; j < KEYS_PER_ACTION; j++) {
+            keys[i][j] = sf::Keyboard::Unknown;
+        }
+    }
+    keys[ACTION_MOVE_UP][0] = sf::Keyboard::W;
+    keys[ACTION_MOVE_DOWN][0] = sf::Keyboard::S;
+    keys[ACTION_MOVE_LEFT][0] = sf::Keyboard::A;
+    keys[ACTION_MOVE_RIGHT][0] = sf::Keyboard::D;
+    keys[ACTION_FIRE][0] = sf::Keyboard::Space;
+    keys[ACTION_START][0] = sf::Keyboard::S;
+    keys[ACTION_PAUSE][0] = sf::Keyboard::P;
+}
+
+bool KeyBindings::bind(const std::string& binding) {
+    std::size_t equals = binding.find('=');
+    if (equals == std::string::npos) return false;
+
+    int action = 0;
+    while (action < ACTION_COUNT && binding.compare(0, equals, actionNames[action]) != 0) action++;
+    if (action == ACTION_COUNT) return false;
+
+    sf::Keyboard::Key bound[KEYS_PER_ACTION];
+    int count = 0;
+    std::size_t start = equals + 1;
+    while (start <= binding.size()) {
+        std::size_t comma = std::min(binding.find(',', start), binding.size());
+        sf::Keyboard::Key key = keyFromName(binding.substr(start, comma - start));
+        if (key == sf::Keyboard::Unknown || count == KEYS_PER_ACTION) return false;
+        bound[count++] = key;
+        start = comma + 1;
+    }
+
+    for (int j = 0; j < KEYS_PER_ACTION; j++) {
+        keys[action][j] = j < count ? bound[j] : sf::Keyboard::Unknown;
+    }
+    return true;
+}
+
+bool InputState::handle(const sf::Event& event, Clock::time_point now) {
+    if (event.type == sf::Event::LostFocus) {
+        releaseAll();
+        return false;
+    }
+    if (event.type != sf::Event::KeyPressed && event.type != sf::Event::KeyReleased) return false;
+
+    bool down = event.type == sf::Event::KeyPressed;
+    bool bound = false;
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        for (int j = 0; j < KEYS_PER_ACTION; j++) {
+            if (bindings.keys[i][j] != event.key.code) continue;
+            bound = true;
+            // Key repeat sends more KeyPressed events; only the first is an edge.
+            if (held[i] == down) continue;
+            held[i] = down;
+            if (down) pressed[i] = true;
+            if (!changed) {
+                changed = true;
+                changeTime = now;
+            }
+        }
+    }
+    return bound;
+}
+
+void InputState::releaseAll() {
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        held[i] = false;
+    }
+}
+
+InputFrame InputState::take() {
+    InputFrame input = takePresses();
+    input.moveUp = input.moveUp || held[ACTION_MOVE_UP];
+    input.moveDown = input.moveDown || held[ACTION_MOVE_DOWN];
+    input.moveLeft = input.moveLeft || held[ACTION_MOVE_LEFT];
+    input.moveRight = input.moveRight || held[ACTION_MOVE_RIGHT];
+    input.fire = input.fire || held[ACTION_FIRE];
+    return input;
+}
+
+InputFrame InputState::heldFrame() const {
+    InputFrame input;
+    input.moveUp = held[ACTION_MOVE_UP];
+    input.moveDown = held[ACTION_MOVE_DOWN];
+    input.moveLeft = held[ACTION_MOVE_LEFT];
+    input.moveRight = held[ACTION_MOVE_RIGHT];
+    input.fire = held[ACTION_FIRE];
+    return input;
+}
+
+InputFrame InputState::takePresses() {
+    InputFrame input;
+    input.moveUp = pressed[ACTION_MOVE_UP];
+    input.moveDown = pressed[ACTION_MOVE_DOWN];
+    input.moveLeft = pressed[ACTION_MOVE_LEFT];
+    input.moveRight = pressed[ACTION_MOVE_RIGHT];
+    input.fire = pressed[ACTION_FIRE];
+    input.firePressed = pressed[ACTION_FIRE];
+    input.start = pressed[ACTION_START];
+    input.pause = pressed[ACTION_PAUSE];
+
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        pressed[i] = false;
+    }
+    return input;
+}
+
+bool InputState::takeChange(Clock::time_point& since) {
+    if (!changed) return false;
+    changed = false;
+    since = changeTime;
+    return true;
+}
+
+void LatencyStats::taken(std::chrono::steady_clock::time_point since) {
+    if (waiting) return;
+    waiting = true;
+    inputTime = since;
+}
+
+void LatencyStats::presented(std::chrono::steady_clock::time_point now) {
+    if (!waiting) return;
+    waiting = false;
+    add(now - inputTime);
+}
+
+void LatencyStats::add(std::chrono::steady_clock::duration latency) {
+    std::uint32_t micros = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    samples[next] = micros;
+    next = (next + 1) % LATENCY_SAMPLES;
+    if (count < LATENCY_SAMPLES) count++;
+    total += micros;
+    measured++;
+    worst = std::max(worst, micros);
+}
+
+void LatencyStats::print() const {
+    if (measured == 0) {
+        std::fprintf(stderr, "Input latency: no input was presented\n");
+        return;
+    }
+    std::vector<std::uint32_t> sorted(samples, samples + count);
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](float fraction) { return sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))] / 1000.0; };
+    std::fprintf(stderr, "Input latency over %llu inputs (ms): mean %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+        static_cast<unsigned long long>(measured), total / 1000.0 / measured, at(0.5f), at(0.95f), at(0.99f), worst / 1000.0);
+}
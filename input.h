@@ -0,0 +1,77 @@
+#pragma once
+#include <SFML/Window.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "simulation.h"
+
+enum Action {
+    ACTION_MOVE_UP,
+    ACTION_MOVE_DOWN,
+    ACTION_MOVE_LEFT,
+    ACTION_MOVE_RIGHT,
+    ACTION_FIRE,
+    ACTION_START,
+    ACTION_PAUSE,
+    ACTION_COUNT
+};
+
+const int KEYS_PER_ACTION = 2;
+
+// Keys bound to each action; unused entries are sf::Keyboard::Unknown. One
+// key may drive several actions ('S' starts the game and moves down).
+struct KeyBindings {
+    sf::Keyboard::Key keys[ACTION_COUNT][KEYS_PER_ACTION];
+
+    KeyBindings();
+    // Parses "fire=Space" or "left=A,Left" and replaces that action's keys.
+    bool bind(const std::string& binding);
+};
+
+// Keyboard state built only from KeyPressed/KeyReleased events, so it never
+// depends on when during a frame the device is asked. Presses are latched
+// until a tick takes them, so a tap shorter than a tick still fires once.
+struct InputState {
+    typedef std::chrono::steady_clock Clock;
+
+    KeyBindings bindings;
+    bool held[ACTION_COUNT] = {};
+    bool pressed[ACTION_COUNT] = {};
+    // When the oldest change not yet taken by a tick arrived.
+    bool changed = false;
+    Clock::time_point changeTime;
+
+    // Returns true if the event was a key bound to an action.
+    bool handle(const sf::Event& event, Clock::time_point now);
+    void releaseAll();
+    // The input for one tick; clears the latched presses.
+    InputFrame take();
+    // take() in two halves: the keys down right now, and only the presses
+    // since the last take, which it clears.
+    InputFrame heldFrame() const;
+    InputFrame takePresses();
+    // True once per batch of changes, with the time the first of them arrived.
+    bool takeChange(Clock::time_point& since);
+};
+
+const int LATENCY_SAMPLES = 4096;
+
+// Input-to-present latency: from the moment an input event was read to the
+// display() of the first frame that shows a tick built from it.
+struct LatencyStats {
+    std::uint32_t samples[LATENCY_SAMPLES];
+    int count = 0;
+    int next = 0;
+    std::uint64_t total = 0;
+    std::uint64_t measured = 0;
+    std::uint32_t worst = 0;
+    // A tick took input that no presented frame has shown yet.
+    bool waiting = false;
+    std::chrono::steady_clock::time_point inputTime;
+
+    void taken(std::chrono::steady_clock::time_point since);
+    // Called right after display(); completes the waiting measurement.
+    void presented(std::chrono::steady_clock::time_point now);
+    void add(std::chrono::steady_clock::duration latency);
+    void print() const;
+};
@@ -0,0 +1,99 @@
+#include "mixer.h"
+
+Mixer::Mixer(AudioBackend& audioBackend) : backend(audioBackend) {
+}
+
+void Mixer::setEffect(int effect, const EffectConfig& config) {
+    effects[effect] = config;
+}
+
+void Mixer::post(int effect) {
+    stats.posted++;
+    if (effect < 0 || effect >= MIXER_EFFECTS || queueCount == MIXER_QUEUE_CAPACITY) {
+        stats.dropped++;
+        return;
+    }
+    queue[queueCount++] = effect;
+}
+
+void Mixer::update(float dt) {
+    now += dt;
+    for (auto& voice : voices) {
+        if (voice.effect >= 0 && voice.end <= now) {
+            voice.effect = -1;
+        }
+    }
+
+    for (int i = 0; i < queueCount; i++) {
+        start(queue[i]);
+    }
+    queueCount = 0;
+}
+
+void Mixer::stopAll() {
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        if (voices[i].effect >= 0) {
+            backend.stop(i);
+            voices[i].effect = -1;
+        }
+    }
+    queueCount = 0;
+}
+
+int Mixer::activeVoices() const {
+    int count = 0;
+    for (const auto& voice : voices) {
+        if (voice.effect >= 0) count++;
+    }
+    return count;
+}
+
+int Mixer::findVoice(int effect) const {
+    const EffectConfig& config = effects[effect];
+
+    int sameCount = 0;
+    int oldestSame = -1;
+    int freeVoice = -1;
+    int victim = -1;
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        const Voice& voice = voices[i];
+        if (voice.effect < 0) {
+            if (freeVoice < 0) freeVoice = i;
+            continue;
+        }
+        if (voice.effect == effect) {
+            sameCount++;
+            if (oldestSame < 0 || voice.start < voices[oldestSame].start) oldestSame = i;
+        }
+        if (voice.priority <= config.priority) {
+            if (victim < 0 || voice.priority < voices[victim].priority ||
+                (voice.priority == voices[victim].priority && voice.start < voices[victim].start)) {
+                victim = i;
+            }
+        }
+    }
+
+    if (sameCount >= config.maxVoices) return oldestSame;
+    if (freeVoice >= 0) return freeVoice;
+    return victim;
+}
+
+void Mixer::start(int effect) {
+    int index = findVoice(effect);
+    if (index < 0) {
+        stats.dropped++;
+        return;
+    }
+
+    Voice& voice = voices[index];
+    if (voice.effect >= 0) {
+        backend.stop(index);
+        stats.stolen++;
+    }
+    voice.effect = effect;
+    voice.priority = effects[effect].priority;
+    voice.start = now;
+    voice.end = now + effects[effect].duration;
+    backend.play(index, effect);
+    stats.played++;
+}
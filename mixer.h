@@ -0,0 +1,69 @@
+#pragma once
+
+const int MIXER_VOICES = 16;
+const int MIXER_EFFECTS = 16;
+const int MIXER_QUEUE_CAPACITY = 64;
+
+// Where the mixer's decisions end up. The mixer does all voice bookkeeping
+// itself, so a backend only has to start and stop playback on a voice.
+struct AudioBackend {
+    virtual ~AudioBackend() {}
+    virtual void play(int voice, int effect) = 0;
+    virtual void stop(int voice) = 0;
+};
+
+// Discards everything; lets the mixer run headless in tests and benchmarks.
+struct NullAudioBackend : AudioBackend {
+    long long plays = 0;
+    long long stops = 0;
+
+    void play(int, int) override { plays++; }
+    void stop(int) override { stops++; }
+};
+
+struct EffectConfig {
+    float duration = 0.0f;
+    int maxVoices = 1;
+    int priority = 0;
+};
+
+struct MixerStats {
+    long long posted = 0;
+    long long played = 0;
+    long long stolen = 0;
+    long long dropped = 0;
+};
+
+// Fixed pool of voices fed from a command queue. post() only records the
+// request; update() retires finished voices and starts queued effects. An
+// effect that already uses all of its voices replaces its own oldest voice.
+// Otherwise it takes a free voice, or steals the lowest-priority, oldest voice
+// whose priority does not exceed its own, or is dropped.
+struct Mixer {
+    struct Voice {
+        int effect = -1;
+        int priority = 0;
+        double start = 0.0;
+        double end = 0.0;
+    };
+
+    AudioBackend& backend;
+    EffectConfig effects[MIXER_EFFECTS];
+    Voice voices[MIXER_VOICES];
+    int queue[MIXER_QUEUE_CAPACITY];
+    int queueCount = 0;
+    double now = 0.0;
+    MixerStats stats;
+
+    explicit Mixer(AudioBackend& audioBackend);
+
+    void setEffect(int effect, const EffectConfig& config);
+    void post(int effect);
+    void update(float dt);
+    void stopAll();
+    int activeVoices() const;
+
+private:
+    void start(int effect);
+    int findVoice(int effect) const;
+};
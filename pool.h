@@ -0,0 +1,80 @@
+#pragma once
+
+// Fixed-capacity object pool. dense[0, count) holds the indices of live
+// objects and dense[count, Capacity) is the free list, so spawn() and
+// release() are O(1), iteration only touches live objects, and nothing is
+// allocated or compacted after construction. Slot indices stay stable while
+// an object is alive.
+template <class T, int Capacity>
+struct Pool {
+    T items[Capacity];
+    bool alive[Capacity];
+    int dense[Capacity];
+    int position[Capacity];
+    int count = 0;
+
+    Pool() {
+        clear();
+    }
+
+    static int capacity() {
+        return Capacity;
+    }
+
+    void clear() {
+        for (int i = 0; i < Capacity; i++) {
+            alive[i] = false;
+            dense[i] = i;
+            position[i] = i;
+        }
+        count = 0;
+    }
+
+    // Returns the index of a fresh slot, or -1 when the pool is full.
+    int spawn(const T& item) {
+        if (count == Capacity) return -1;
+        int index = dense[count++];
+        items[index] = item;
+        alive[index] = true;
+        return index;
+    }
+
+    void release(int index) {
+        if (!alive[index]) return;
+        alive[index] = false;
+        int last = dense[--count];
+        int hole = position[index];
+        dense[hole] = last;
+        position[last] = hole;
+        dense[count] = index;
+        position[index] = count;
+    }
+
+    bool isAlive(int index) const {
+        return alive[index];
+    }
+
+    T& operator[](int index) {
+        return items[index];
+    }
+
+    const T& operator[](int index) const {
+        return items[index];
+    }
+
+    // f(index, item) for every live object, newest first. f may release the
+    // object it was called with.
+    template <class F>
+    void forEach(F f) {
+        for (int i = count - 1; i >= 0; i--) {
+            f(dense[i], items[dense[i]]);
+        }
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for (int i = count - 1; i >= 0; i--) {
+            f(dense[i], items[dense[i]]);
+        }
+    }
+};
@@ -0,0 +1,139 @@
+#include "profiler.h"
+#include <fstream>
+
+static const char* const sectionNames[PROFILE_SECTION_COUNT] = {
+    "hud",
+    "moveAliens",
+    "alienCollisions",
+    "alienFire",
+    "shipCollisions",
+    "boltCollisions",
+    "bunkerCollisions",
+    "fireBolt",
+    "shipMovement",
+    "cleanup",
+    "render",
+    "display",
+    "frame",
+};
+
+const char* profileSectionName(int section) {
+    return sectionNames[section];
+}
+
+#if INVADERS_PROFILE
+
+static int bucketFor(std::uint32_t value) {
+    if (value < 16) return static_cast<int>(value);
+    int exponent = 31;
+    while (!(value >> exponent)) exponent--;
+    int sub = static_cast<int>((value >> (exponent - 3)) & 7);
+    return 16 + (exponent - 4) * 8 + sub;
+}
+
+static std::uint32_t bucketValue(int bucket) {
+    if (bucket < 16) return static_cast<std::uint32_t>(bucket);
+    int exponent = (bucket - 16) / 8 + 4;
+    int sub = (bucket - 16) % 8;
+    std::uint64_t low = (std::uint64_t(8 + sub)) << (exponent - 3);
+    std::uint64_t width = std::uint64_t(1) << (exponent - 3);
+    return static_cast<std::uint32_t>(low + width / 2);
+}
+
+void RollingHistogram::add(std::uint32_t value) {
+    if (count == PROFILE_WINDOW) {
+        buckets[bucketFor(samples[next])]--;
+    }
+    else {
+        count++;
+    }
+    samples[next] = value;
+    buckets[bucketFor(value)]++;
+    next = (next + 1) % PROFILE_WINDOW;
+}
+
+std::uint32_t RollingHistogram::percentile(float fraction) const {
+    if (count == 0) return 0;
+    int rank = static_cast<int>(fraction * count + 0.5f);
+    if (rank < 1) rank = 1;
+    int seen = 0;
+    for (int bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank) return bucketValue(bucket);
+    }
+    return max();
+}
+
+std::uint32_t RollingHistogram::max() const {
+    std::uint32_t largest = 0;
+    for (int i = 0; i < count; i++) {
+        if (samples[i] > largest) largest = samples[i];
+    }
+    return largest;
+}
+
+Profiler::Profiler(std::size_t frameCapacity) : records(frameCapacity * PROFILE_SECTION_COUNT), recordCapacity(frameCapacity) {
+}
+
+void Profiler::endFrame() {
+    auto now = std::chrono::steady_clock::now();
+    current[PROFILE_FRAME] = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStart).count());
+    frameStart = now;
+
+    if (recordCapacity > 0) {
+        std::uint32_t* record = &records[(frameIndex % recordCapacity) * PROFILE_SECTION_COUNT];
+        for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+            record[i] = current[i];
+        }
+        if (recordCount < recordCapacity) recordCount++;
+    }
+
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        histograms[i].add(current[i]);
+        current[i] = 0;
+    }
+    frameIndex++;
+}
+
+void Profiler::flush(std::uint64_t* totals) {
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        totals[i] += current[i];
+        current[i] = 0;
+    }
+}
+
+void Profiler::merge(const std::uint64_t* totals, std::uint64_t* seen) {
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        add(i, static_cast<std::uint32_t>(totals[i] - seen[i]));
+        seen[i] = totals[i];
+    }
+}
+
+bool Profiler::writeCsv(const char* path) const {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    file << "frame";
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        file << ',' << sectionNames[i] << "_ns";
+    }
+    file << '\n';
+
+    std::uint64_t first = frameIndex - recordCount;
+    for (std::uint64_t frame = first; frame < frameIndex; frame++) {
+        const std::uint32_t* record = &records[(frame % recordCapacity) * PROFILE_SECTION_COUNT];
+        file << frame;
+        for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+            file << ',' << record[i];
+        }
+        file << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+Profiler& profiler() {
+    static thread_local Profiler instance;
+    return instance;
+}
+
+#endif
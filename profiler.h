@@ -0,0 +1,116 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Scoped frame profiling. On by default in debug builds; define
+// INVADERS_PROFILE=1 or 0 to force it. When off, every macro below expands
+// to nothing and no profiler code is compiled in.
+#ifndef INVADERS_PROFILE
+#ifdef NDEBUG
+#define INVADERS_PROFILE 0
+#else
+#define INVADERS_PROFILE 1
+#endif
+#endif
+
+enum ProfileSection {
+    PROFILE_HUD,
+    PROFILE_MOVE_ALIENS,
+    PROFILE_ALIEN_COLLISIONS,
+    PROFILE_ALIEN_FIRE,
+    PROFILE_SHIP_COLLISIONS,
+    PROFILE_BOLT_COLLISIONS,
+    PROFILE_BUNKER_COLLISIONS,
+    PROFILE_FIRE_BOLT,
+    PROFILE_SHIP_MOVEMENT,
+    PROFILE_CLEANUP,
+    PROFILE_RENDER,
+    PROFILE_DISPLAY,
+    PROFILE_FRAME,
+    PROFILE_SECTION_COUNT
+};
+
+const char* profileSectionName(int section);
+
+#if INVADERS_PROFILE
+
+const int PROFILE_WINDOW = 256;
+const int PROFILE_BUCKETS = 240;
+
+// Log-linear histogram over the last PROFILE_WINDOW samples (nanoseconds).
+// Values below 16 get their own bucket; above that each power of two is split
+// into eight buckets, so percentiles are accurate to about 6%.
+struct RollingHistogram {
+    std::uint32_t samples[PROFILE_WINDOW] = {};
+    std::uint16_t buckets[PROFILE_BUCKETS] = {};
+    int next = 0;
+    int count = 0;
+
+    void add(std::uint32_t value);
+    std::uint32_t percentile(float fraction) const;
+    std::uint32_t max() const;
+};
+
+struct Profiler {
+    RollingHistogram histograms[PROFILE_SECTION_COUNT];
+    std::uint32_t current[PROFILE_SECTION_COUNT] = {};
+    std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+    // Per-frame records for the CSV, PROFILE_SECTION_COUNT values each. Fixed
+    // size; once full the oldest frames are overwritten.
+    std::vector<std::uint32_t> records;
+    std::size_t recordCapacity = 0;
+    std::size_t recordCount = 0;
+    std::uint64_t frameIndex = 0;
+
+    bool overlayVisible = false;
+
+    explicit Profiler(std::size_t frameCapacity = 60 * 60 * 10);
+
+    void add(int section, std::uint32_t nanoseconds) {
+        current[section] += nanoseconds;
+    }
+
+    void endFrame();
+    bool writeCsv(const char* path) const;
+
+    // Sections timed on a thread that does not end frames. That thread calls
+    // flush() instead of endFrame() to add its times to running totals; the
+    // thread that ends frames hands the newest totals it was given to merge(),
+    // which adds what they gained since seen and updates seen.
+    void flush(std::uint64_t* totals);
+    void merge(const std::uint64_t* totals, std::uint64_t* seen);
+};
+
+// Each thread records into its own profiler, so scopes never contend.
+Profiler& profiler();
+
+struct ProfileScope {
+    int section;
+    std::chrono::steady_clock::time_point start;
+
+    explicit ProfileScope(int profileSection) : section(profileSection), start(std::chrono::steady_clock::now()) {
+    }
+
+    ~ProfileScope() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        profiler().add(section, static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(section) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(section)
+#define PROFILE_END_FRAME() profiler().endFrame()
+#define PROFILE_FLUSH(totals) profiler().flush(totals)
+#define PROFILE_MERGE(totals, seen) profiler().merge(totals, seen)
+
+#else
+
+#define PROFILE_SCOPE(section) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#define PROFILE_FLUSH(totals) ((void)(totals))
+#define PROFILE_MERGE(totals, seen) ((void)(totals), (void)(seen))
+
+#endif
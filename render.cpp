@@ -0,0 +1,157 @@
+#include "render.h"
+#include <algorithm>
+#include <cmath>
+
+void loadFrames(std::vector<sf::IntRect>& frames, int frameWidth, int frameHeight, int startX, int startY, int count, int columns) {
+    for (int i = 0; i < count; i++) {
+        int x = startX + (i % columns) * frameWidth;
+        int y = startY + (i / columns) * frameHeight;
+        frames.push_back(sf::IntRect(x, y, frameWidth, frameHeight));
+    }
+}
+
+static void alienMovementFrames(std::vector<sf::IntRect>& frames) {
+    loadFrames(frames, 36, 36, 0, 0, ALIEN_MOVE_FRAMES, 2);
+}
+
+static void alienDeathFrames(std::vector<sf::IntRect>& frames) {
+    loadFrames(frames, 36, 36, 0, 36, ALIEN_DEATH_FRAMES, 2);
+}
+
+static void shipFrames(std::vector<sf::IntRect>& frames) {
+    loadFrames(frames, 44, 44, 0, 0, SHIP_DEATH_FRAMES, 6);
+}
+
+static bool loadMasks(std::vector<CollisionMask>& masks, const Resources& resources, TextureId texture, const std::vector<sf::IntRect>& frames) {
+    sf::Image image;
+    if (!loadImage(image, resources, texture)) return false;
+
+    sf::Vector2u size = image.getSize();
+    masks.clear();
+    for (const sf::IntRect& frame : frames) {
+        if (frame.left + frame.width > static_cast<int>(size.x) || frame.top + frame.height > static_cast<int>(size.y)) return false;
+        masks.push_back(maskFromPixels(image.getPixelsPtr(), size.x, frame.left, frame.top, frame.width, frame.height));
+    }
+    return true;
+}
+
+bool loadSpriteMasks(SpriteMasks& masks, const Resources& resources) {
+    std::vector<sf::IntRect> alien;
+    std::vector<sf::IntRect> ship;
+    alienMovementFrames(alien);
+    shipFrames(ship);
+    return loadMasks(masks.alien, resources, TEXTURE_ALIEN_STRIP, alien) && loadMasks(masks.ship, resources, TEXTURE_SHIP_STRIP, ship);
+}
+
+PlayRenderer::PlayRenderer(const Resources& resources)
+    : aliens(&getTexture(resources, TEXTURE_ALIEN_STRIP)), bunkers(&bunkerAtlas), ship(&getTexture(resources, TEXTURE_SHIP_STRIP)) {
+    bunkerAtlas.create(BUNKER_WIDTH * BUNKER_COUNT, BUNKER_HEIGHT);
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        for (int row = 0; row < BUNKER_HEIGHT; row++) {
+            uploadedRows[i][row] = 0;
+        }
+    }
+    for (int i = 0; i < BUNKER_WIDTH * BUNKER_HEIGHT * 4; i++) {
+        bunkerPixels[i] = 0;
+    }
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        bunkerAtlas.update(bunkerPixels, BUNKER_WIDTH, BUNKER_HEIGHT, i * BUNKER_WIDTH, 0);
+    }
+
+    alienMovementFrames(movementFrames);
+    alienDeathFrames(deathFrames);
+    shipFrames(shipDeathFrames);
+}
+
+// Anything that moved further than this in one tick (a respawned ship, a
+// reused pool slot, a new wave) snaps instead of sliding across the screen.
+const float MAX_TICK_TRAVEL = 48.0f;
+
+static sf::Vector2f blend(float fromX, float fromY, float toX, float toY, float alpha) {
+    if (std::fabs(toX - fromX) > MAX_TICK_TRAVEL || std::fabs(toY - fromY) > MAX_TICK_TRAVEL) {
+        return sf::Vector2f(toX, toY);
+    }
+    return sf::Vector2f(fromX + (toX - fromX) * alpha, fromY + (toY - fromY) * alpha);
+}
+
+void PlayRenderer::build(const Simulation& sim) {
+    build(sim, sim, 1.0f);
+}
+
+void PlayRenderer::uploadBunkers(const Simulation& sim) {
+    const sf::Color color(32, 255, 32);
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        const Bunker& bunker = sim.bunkers[i];
+        int top = 0;
+        while (top < BUNKER_HEIGHT && bunker.rows[top] == uploadedRows[i][top]) top++;
+        if (top == BUNKER_HEIGHT) continue;
+        int bottom = BUNKER_HEIGHT;
+        while (bunker.rows[bottom - 1] == uploadedRows[i][bottom - 1]) bottom--;
+
+        for (int row = top; row < bottom; row++) {
+            sf::Uint8* pixel = bunkerPixels + (row - top) * BUNKER_WIDTH * 4;
+            for (int x = 0; x < BUNKER_WIDTH; x++, pixel += 4) {
+                bool solid = (bunker.rows[row] >> x) & 1;
+                pixel[0] = color.r;
+                pixel[1] = color.g;
+                pixel[2] = color.b;
+                pixel[3] = solid ? 255 : 0;
+            }
+            uploadedRows[i][row] = bunker.rows[row];
+        }
+        bunkerAtlas.update(bunkerPixels, BUNKER_WIDTH, bottom - top, i * BUNKER_WIDTH, top);
+    }
+}
+
+void PlayRenderer::build(const Simulation& previous, const Simulation& sim, float alpha) {
+    aliens.begin();
+    bunkers.begin();
+    ship.begin();
+    shapes.begin();
+
+    uploadBunkers(sim);
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        bunkers.addSprite(sim.bunkers[i].x, sim.bunkers[i].y, sf::IntRect(i * BUNKER_WIDTH, 0, BUNKER_WIDTH, BUNKER_HEIGHT));
+    }
+
+    const Formation& formation = sim.formation;
+    const Formation& before = previous.formation;
+    bool sameFormation = before.x.size() == formation.x.size() && previous.wave == sim.wave;
+    forEachSlot(formation.alive, formation.dying, [&](int slot) {
+        const sf::IntRect& frame = formation.isDying(slot) ? deathFrames[formation.deathFrame[slot]] : movementFrames[formation.walkFrame];
+        sf::Vector2f position(formation.x[slot], formation.y[slot]);
+        if (sameFormation) {
+            position = blend(before.x[slot], before.y[slot], formation.x[slot], formation.y[slot], alpha);
+        }
+        aliens.addSprite(position.x, position.y, frame);
+    });
+
+    shapes.addRect(0, sim.barrierY, sim.worldWidth, 1, sf::Color::White);
+    sim.alienBolts.forEach([&](int index, const Bolt& bolt) {
+        sf::Vector2f position(bolt.x, bolt.y);
+        if (previous.alienBolts.isAlive(index)) {
+            const Bolt& last = previous.alienBolts[index];
+            position = blend(last.x, last.y, bolt.x, bolt.y, alpha);
+        }
+        shapes.addRect(position.x, position.y, BOLT_WIDTH, BOLT_HEIGHT, sf::Color::Red);
+    });
+    sim.playerBolts.forEach([&](int index, const Bolt& bolt) {
+        sf::Vector2f position(bolt.x, bolt.y);
+        if (previous.playerBolts.isAlive(index)) {
+            const Bolt& last = previous.playerBolts[index];
+            position = blend(last.x, last.y, bolt.x, bolt.y, alpha);
+        }
+        shapes.addRect(position.x, position.y, BOLT_WIDTH, BOLT_HEIGHT, sf::Color::Blue);
+    });
+
+    int shipFrame = std::min(sim.ship.currentFrame, SHIP_DEATH_FRAMES - 1);
+    sf::Vector2f shipPosition = blend(previous.ship.x, previous.ship.y, sim.ship.x, sim.ship.y, alpha);
+    ship.addSprite(shipPosition.x, shipPosition.y, shipDeathFrames[shipFrame]);
+}
+
+void PlayRenderer::draw(sf::RenderTarget& target) const {
+    aliens.draw(target);
+    bunkers.draw(target);
+    shapes.draw(target);
+    ship.draw(target);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "batch.h"
+#include "resources.h"
+#include "simulation.h"
+
+void loadFrames(std::vector<sf::IntRect>& frames, int frameWidth, int frameHeight, int startX, int startY, int count, int columns);
+
+// Builds a collision mask for every alien walk frame and ship frame from the
+// sprite sheets' alpha, using the same frame rectangles the renderer draws.
+bool loadSpriteMasks(SpriteMasks& masks, const Resources& resources);
+
+// Turns a Simulation into four batches: the alien formation, the bunkers, the
+// ship, and the untextured barrier and bolts. Works on any render target, so
+// the same code draws to the window and to offscreen textures.
+struct PlayRenderer {
+    // All bunkers side by side in one texture. Each build compares the
+    // bunkers' rows with what was last uploaded and sends only the changed
+    // band of rows to the GPU.
+    sf::Texture bunkerAtlas;
+    std::uint64_t uploadedRows[BUNKER_COUNT][BUNKER_HEIGHT];
+    sf::Uint8 bunkerPixels[BUNKER_WIDTH * BUNKER_HEIGHT * 4];
+
+    SpriteBatch aliens;
+    SpriteBatch bunkers;
+    SpriteBatch ship;
+    SpriteBatch shapes;
+    std::vector<sf::IntRect> movementFrames;
+    std::vector<sf::IntRect> deathFrames;
+    std::vector<sf::IntRect> shipDeathFrames;
+
+    explicit PlayRenderer(const Resources& resources);
+
+    void build(const Simulation& sim);
+    // Draws positions blended between two consecutive ticks; alpha 0 is
+    // previous, 1 is current.
+    void build(const Simulation& previous, const Simulation& current, float alpha);
+    void uploadBunkers(const Simulation& sim);
+    void draw(sf::RenderTarget& target) const;
+};
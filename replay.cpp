@@ -0,0 +1,266 @@
+#include "replay.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+const std::size_t HEADER_SIZE = 4 + 2 + 2 + 8 + 8 + 8 + 4;
+const std::size_t TICK_COUNT_OFFSET = 16;
+
+enum InputBit {
+    INPUT_UP = 1 << 0,
+    INPUT_DOWN = 1 << 1,
+    INPUT_LEFT = 1 << 2,
+    INPUT_RIGHT = 1 << 3,
+    INPUT_FIRE = 1 << 4,
+    INPUT_START = 1 << 5,
+    INPUT_PAUSE = 1 << 6,
+    INPUT_FIRE_PRESSED = 1 << 7,
+};
+
+std::uint8_t packInput(const InputFrame& input) {
+    std::uint8_t mask = 0;
+    if (input.moveUp) mask |= INPUT_UP;
+    if (input.moveDown) mask |= INPUT_DOWN;
+    if (input.moveLeft) mask |= INPUT_LEFT;
+    if (input.moveRight) mask |= INPUT_RIGHT;
+    if (input.fire) mask |= INPUT_FIRE;
+    if (input.start) mask |= INPUT_START;
+    if (input.pause) mask |= INPUT_PAUSE;
+    if (input.firePressed) mask |= INPUT_FIRE_PRESSED;
+    return mask;
+}
+
+InputFrame unpackInput(std::uint8_t mask) {
+    InputFrame input;
+    input.moveUp = (mask & INPUT_UP) != 0;
+    input.moveDown = (mask & INPUT_DOWN) != 0;
+    input.moveLeft = (mask & INPUT_LEFT) != 0;
+    input.moveRight = (mask & INPUT_RIGHT) != 0;
+    input.fire = (mask & INPUT_FIRE) != 0;
+    input.start = (mask & INPUT_START) != 0;
+    input.pause = (mask & INPUT_PAUSE) != 0;
+    input.firePressed = (mask & INPUT_FIRE_PRESSED) != 0;
+    return input;
+}
+
+struct Hasher {
+    std::uint64_t value = 14695981039346656037ULL;
+
+    void bytes(const void* data, std::size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; i++) {
+            value ^= p[i];
+            value *= 1099511628211ULL;
+        }
+    }
+
+    template <class T>
+    void add(const T& field) {
+        bytes(&field, sizeof(field));
+    }
+
+    template <class T>
+    void add(const std::vector<T>& field) {
+        if (!field.empty()) bytes(field.data(), field.size() * sizeof(T));
+    }
+};
+
+std::uint64_t hashSimulation(const Simulation& sim) {
+    Hasher hash;
+    hash.add(sim.gameState);
+    hash.add(sim.direction);
+    hash.add(sim.moveDown);
+    hash.add(sim.lives);
+    hash.add(sim.wave);
+    hash.add(sim.score);
+    hash.add(sim.alienSpeed);
+    hash.add(sim.alienBoltSpeed);
+    hash.add(sim.clock.tick);
+    hash.add(sim.clock.remainder);
+    hash.add(sim.nextFireTick);
+    hash.add(sim.nextAlienFireTick);
+    hash.add(sim.fireLatch);
+    hash.add(sim.rng.state);
+
+    hash.add(sim.ship.x);
+    hash.add(sim.ship.y);
+    hash.add(sim.ship.isDying);
+    hash.add(sim.ship.currentFrame);
+    hash.add(sim.ship.deathTick);
+
+    const Formation& formation = sim.formation;
+    hash.add(formation.x);
+    hash.add(formation.y);
+    hash.add(formation.alive);
+    hash.add(formation.dying);
+    hash.add(formation.deathFrame);
+    hash.add(formation.deathTick);
+    hash.add(formation.walkFrame);
+    hash.add(formation.walkTick);
+
+    for (const Bunker& bunker : sim.bunkers) {
+        hash.add(bunker.rows);
+    }
+
+    sim.playerBolts.forEach([&hash](int index, const Bolt& bolt) {
+        hash.add(index);
+        hash.add(bolt.x);
+        hash.add(bolt.y);
+    });
+    sim.alienBolts.forEach([&hash](int index, const Bolt& bolt) {
+        hash.add(index);
+        hash.add(bolt.x);
+        hash.add(bolt.y);
+    });
+    return hash.value;
+}
+
+static void writeU16(std::ofstream& file, std::uint16_t value) {
+    unsigned char bytes[2] = { static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8) };
+    file.write(reinterpret_cast<const char*>(bytes), 2);
+}
+
+static void writeU64(std::ofstream& file, std::uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+    file.write(reinterpret_cast<const char*>(bytes), 8);
+}
+
+static void writeU32(std::ofstream& file, std::uint32_t value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+    file.write(reinterpret_cast<const char*>(bytes), 4);
+}
+
+static std::uint32_t readU32(const std::uint8_t* bytes) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= static_cast<std::uint32_t>(bytes[i]) << (i * 8);
+    return value;
+}
+
+static std::uint64_t readU64(const std::uint8_t* bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value |= static_cast<std::uint64_t>(bytes[i]) << (i * 8);
+    return value;
+}
+
+bool InputRecorder::open(const std::string& path, std::uint64_t seed, std::uint32_t flags) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write("INVR", 4);
+    writeU16(file, REPLAY_VERSION);
+    writeU16(file, static_cast<std::uint16_t>(TICKS_PER_SECOND));
+    writeU64(file, seed);
+    writeU64(file, 0);
+    writeU64(file, 0);
+    writeU32(file, flags);
+    runLength = 0;
+    ticks = 0;
+    return static_cast<bool>(file);
+}
+
+void InputRecorder::flushRun() {
+    if (runLength == 0) return;
+    file.put(static_cast<char>(runMask));
+    std::uint32_t length = runLength;
+    do {
+        std::uint8_t byte = length & 0x7f;
+        length >>= 7;
+        if (length) byte |= 0x80;
+        file.put(static_cast<char>(byte));
+    } while (length);
+    runLength = 0;
+}
+
+void InputRecorder::record(const InputFrame& input) {
+    if (!file.is_open()) return;
+    std::uint8_t mask = packInput(input);
+    if (runLength > 0 && (mask != runMask || runLength == 0xffffffffu)) {
+        flushRun();
+    }
+    runMask = mask;
+    runLength++;
+    ticks++;
+}
+
+bool InputRecorder::close(std::uint64_t finalHash) {
+    if (!file.is_open()) return false;
+    flushRun();
+    file.seekp(TICK_COUNT_OFFSET);
+    writeU64(file, ticks);
+    writeU64(file, finalHash);
+    bool ok = static_cast<bool>(file);
+    file.close();
+    return ok;
+}
+
+bool InputReplay::open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), "INVR", 4) != 0) return false;
+
+    std::uint16_t version = static_cast<std::uint16_t>(data[4] | (data[5] << 8));
+    std::uint16_t rate = static_cast<std::uint16_t>(data[6] | (data[7] << 8));
+    if (version != REPLAY_VERSION || rate != TICKS_PER_SECOND) return false;
+
+    seed = readU64(&data[8]);
+    tickCount = readU64(&data[TICK_COUNT_OFFSET]);
+    finalHash = readU64(&data[TICK_COUNT_OFFSET + 8]);
+    flags = readU32(&data[TICK_COUNT_OFFSET + 16]);
+    position = HEADER_SIZE;
+    runRemaining = 0;
+    ticksRead = 0;
+    return true;
+}
+
+bool InputReplay::next(InputFrame& input) {
+    if (finished()) return false;
+    if (runRemaining == 0) {
+        if (position >= data.size()) return false;
+        runMask = data[position++];
+        // A 32-bit run length takes at most five bytes; a longer or cut-off
+        // one means the log is corrupt.
+        std::uint32_t length = 0;
+        for (int shift = 0;; shift += 7) {
+            if (shift >= 35 || position >= data.size()) return false;
+            std::uint8_t byte = data[position++];
+            length |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        runRemaining = length;
+        if (runRemaining == 0) return false;
+    }
+    runRemaining--;
+    ticksRead++;
+    input = unpackInput(runMask);
+    return true;
+}
+
+int fastForwardReplay(InputReplay& replay, const SpriteMasks* masks) {
+    Simulation sim(replay.seed);
+    if (replay.flags & REPLAY_PIXEL_MASKS) {
+        if (!masks) {
+            std::cerr << "Replay was recorded with pixel collision masks, which are not loaded" << std::endl;
+            return 1;
+        }
+        sim.masks = masks;
+    }
+    InputFrame input;
+
+    auto start = std::chrono::steady_clock::now();
+    while (replay.next(input)) {
+        sim.step(input, TICK_SECONDS);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t hash = hashSimulation(sim);
+    bool match = replay.ticksRead == replay.tickCount && hash == replay.finalHash;
+    std::cout << "Replayed " << replay.ticksRead << " ticks in " << seconds << " s ("
+        << (seconds > 0 ? replay.ticksRead / seconds : 0.0) << " ticks/s), final hash "
+        << std::hex << hash << (match ? " matches" : " does NOT match ") ;
+    if (!match) std::cout << replay.finalHash;
+    std::cout << std::dec << std::endl;
+    return match ? 0 : 2;
+}
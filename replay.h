@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+// Replay log layout (little endian):
+//   header  "INVR" u16 version u16 ticksPerSecond u64 seed u64 tickCount u64 finalHash u32 flags
+//   body    runs of [u8 input mask][LEB128 run length], one mask per tick
+// tickCount and finalHash are filled in when the recording is closed, so a
+// replay can check that it reproduced the session bit for bit.
+
+const std::uint16_t REPLAY_VERSION = 6;
+
+// Simulation options a replay has to match to reproduce the recording.
+enum ReplayFlag {
+    REPLAY_PIXEL_MASKS = 1 << 0,
+};
+
+std::uint8_t packInput(const InputFrame& input);
+InputFrame unpackInput(std::uint8_t mask);
+
+// FNV-1a over every field that influences future steps.
+std::uint64_t hashSimulation(const Simulation& sim);
+
+struct InputRecorder {
+    std::ofstream file;
+    std::uint8_t runMask = 0;
+    std::uint32_t runLength = 0;
+    std::uint64_t ticks = 0;
+
+    bool open(const std::string& path, std::uint64_t seed, std::uint32_t flags = 0);
+    void record(const InputFrame& input);
+    bool close(std::uint64_t finalHash);
+    bool isOpen() const { return file.is_open(); }
+
+private:
+    void flushRun();
+};
+
+struct InputReplay {
+    std::vector<std::uint8_t> data;
+    std::size_t position = 0;
+    std::uint8_t runMask = 0;
+    std::uint32_t runRemaining = 0;
+    std::uint64_t seed = 0;
+    std::uint64_t tickCount = 0;
+    std::uint64_t finalHash = 0;
+    std::uint32_t flags = 0;
+    std::uint64_t ticksRead = 0;
+
+    bool open(const std::string& path);
+    bool next(InputFrame& input);
+    bool finished() const { return ticksRead >= tickCount; }
+};
+
+// Runs a whole replay as fast as possible with no window, prints the result
+// and returns 0 when the final state matches the recording. masks must be
+// given when the recording used them.
+int fastForwardReplay(InputReplay& replay, const SpriteMasks* masks = nullptr);
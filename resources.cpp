@@ -0,0 +1,75 @@
+#include "resources.h"
+
+static const char* const fontFiles[FONT_COUNT] = {
+    "Arcade.ttf",
+    "ComicSans.ttf",
+    "RetroGame.ttf",
+};
+
+static const char* const textureFiles[TEXTURE_COUNT] = {
+    "alien-strip1.png",
+    "ship.png",
+    "ship-strip.png",
+};
+
+static const char* const soundFiles[SOUND_COUNT] = {
+    "pew2.wav",
+    "blast1.wav",
+    "pop1.wav",
+    "blast2.wav",
+};
+
+// Reads from the pack without copying when the asset is in it, otherwise
+// from the loose file.
+template <class Asset>
+static bool loadAsset(Asset& asset, const Resources& resources, const char* name) {
+    const void* bytes;
+    std::size_t length;
+    if (resources.pack.isOpen() && resources.pack.find(name, bytes, length)) {
+        return asset.loadFromMemory(bytes, length);
+    }
+    return asset.loadFromFile(resources.directory + name);
+}
+
+bool openAssets(Resources& resources, const std::string& directory) {
+    resources.directory = directory;
+    return resources.pack.open(directory + ASSET_PACK_FILE);
+}
+
+bool loadResources(Resources& resources) {
+    resources.failures.clear();
+
+    for (int i = 0; i < FONT_COUNT; i++) {
+        if (!loadAsset(resources.fonts[i], resources, fontFiles[i])) {
+            resources.failures.push_back(fontFiles[i]);
+        }
+    }
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        if (!loadAsset(resources.textures[i], resources, textureFiles[i])) {
+            resources.failures.push_back(textureFiles[i]);
+        }
+    }
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (!loadAsset(resources.sounds[i], resources, soundFiles[i])) {
+            resources.failures.push_back(soundFiles[i]);
+        }
+    }
+
+    return resources.failures.empty();
+}
+
+const sf::Font& getFont(const Resources& resources, FontId id) {
+    return resources.fonts[id];
+}
+
+const sf::Texture& getTexture(const Resources& resources, TextureId id) {
+    return resources.textures[id];
+}
+
+const sf::SoundBuffer& getSound(const Resources& resources, SoundId id) {
+    return resources.sounds[id];
+}
+
+bool loadImage(sf::Image& image, const Resources& resources, TextureId id) {
+    return loadAsset(image, resources, textureFiles[id]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <string>
+#include <vector>
+#include "assetpack.h"
+
+enum FontId {
+    FONT_ARCADE,
+    FONT_COMIC_SANS,
+    FONT_RETRO_GAME,
+    FONT_COUNT
+};
+
+enum TextureId {
+    TEXTURE_ALIEN_STRIP,
+    TEXTURE_SHIP,
+    TEXTURE_SHIP_STRIP,
+    TEXTURE_COUNT
+};
+
+enum SoundId {
+    SOUND_SHIP_BOLT,
+    SOUND_ALIEN_DESTROYED,
+    SOUND_BOLT_DESTROYED,
+    SOUND_SHIP_DAMAGE,
+    SOUND_COUNT
+};
+
+// Every asset is loaded once at startup and lives as long as the cache, so the
+// references handed out below stay valid for the whole run. The cache must not
+// be copied or moved once sprites and sounds point into it.
+//
+// Assets come from the mapped pack when there is one and from loose files in
+// directory otherwise. Fonts read glyphs straight from the mapping, so the
+// pack is declared first and destroyed last.
+struct Resources {
+    AssetPack pack;
+    std::string directory;
+    sf::Font fonts[FONT_COUNT];
+    sf::Texture textures[TEXTURE_COUNT];
+    sf::SoundBuffer sounds[SOUND_COUNT];
+    std::vector<std::string> failures;
+
+    Resources() = default;
+    Resources(const Resources&) = delete;
+    Resources& operator=(const Resources&) = delete;
+};
+
+// Maps the asset pack in directory if there is one. Needs no graphics
+// context, so it can run before the window exists. Optional: without it
+// loadResources reads loose files from the working directory.
+bool openAssets(Resources& resources, const std::string& directory);
+bool loadResources(Resources& resources);
+
+const sf::Font& getFont(const Resources& resources, FontId id);
+const sf::Texture& getTexture(const Resources& resources, TextureId id);
+const sf::SoundBuffer& getSound(const Resources& resources, SoundId id);
+
+// Loads a texture's source file into CPU memory. Needs no graphics context,
+// so headless tools can read sprite pixels too.
+bool loadImage(sf::Image& image, const Resources& resources, TextureId id);
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 (XSH RR). Small enough to copy into a snapshot, identical on every
+// platform and compiler, and much better distributed than rand().
+struct Rng {
+    std::uint64_t state = 0;
+    std::uint64_t increment = 1;
+
+    Rng() {
+        seed(1);
+    }
+
+    explicit Rng(std::uint64_t value) {
+        seed(value);
+    }
+
+    void seed(std::uint64_t value, std::uint64_t stream = 0x5851f42d4c957f2dULL) {
+        state = 0;
+        increment = (stream << 1) | 1;
+        next();
+        state += value;
+        next();
+    }
+
+    std::uint32_t next() {
+        std::uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+        std::uint32_t rot = static_cast<std::uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // Uniform in [0, bound) without modulo bias.
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t product = static_cast<std::uint64_t>(next()) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            std::uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<std::uint64_t>(next()) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+};
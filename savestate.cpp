@@ -0,0 +1,375 @@
+#include "savestate.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "snapshots are copied as raw bytes");
+static_assert(PLAYER_BOLT_CAPACITY <= SNAPSHOT_BOLTS && ALIEN_BOLT_CAPACITY <= SNAPSHOT_BOLTS, "bolt pools must fit a snapshot");
+
+const std::uint32_t SNAPSHOT_VERSION = 2;
+
+template <class Pool>
+static void capturePool(const Pool& pool, PoolSnapshot& snapshot) {
+    snapshot.count = static_cast<std::uint16_t>(pool.count);
+    for (int i = 0; i < Pool::capacity(); i++) {
+        snapshot.dense[i] = static_cast<std::uint8_t>(pool.dense[i]);
+        if (i < pool.count) snapshot.bolts[i] = pool.items[pool.dense[i]];
+    }
+}
+
+template <class Pool>
+static void restorePool(const PoolSnapshot& snapshot, Pool& pool) {
+    pool.count = snapshot.count;
+    for (int i = 0; i < Pool::capacity(); i++) {
+        int index = snapshot.dense[i];
+        pool.dense[i] = index;
+        pool.position[index] = i;
+        pool.alive[index] = i < snapshot.count;
+        if (i < snapshot.count) pool.items[index] = snapshot.bolts[i];
+    }
+}
+
+bool captureSnapshot(const Simulation& sim, GameSnapshot& snapshot) {
+    const Formation& formation = sim.formation;
+    if (formation.size() > SNAPSHOT_MAX_ALIENS || formation.columns > SNAPSHOT_MAX_COLUMNS) return false;
+    if (sim.worldWidth > SNAPSHOT_MAX_WORLD || sim.worldHeight > SNAPSHOT_MAX_WORLD || sim.barrierY > SNAPSHOT_MAX_WORLD) return false;
+
+    std::memset(static_cast<void*>(&snapshot), 0, sizeof(snapshot));
+    snapshot.gameState = sim.gameState;
+    snapshot.direction = sim.direction;
+    snapshot.moveDown = sim.moveDown;
+    snapshot.fireLatch = sim.fireLatch;
+    snapshot.lives = sim.lives;
+    snapshot.score = sim.score;
+    snapshot.wave = sim.wave;
+    snapshot.alienSpeed = sim.alienSpeed;
+    snapshot.alienBoltSpeed = sim.alienBoltSpeed;
+    snapshot.worldWidth = sim.worldWidth;
+    snapshot.worldHeight = sim.worldHeight;
+    snapshot.barrierY = sim.barrierY;
+    snapshot.formationRows = sim.formationRows;
+    snapshot.formationColumns = sim.formationColumns;
+    snapshot.maxPlayerBolts = sim.maxPlayerBolts;
+    snapshot.tick = sim.clock.tick;
+    snapshot.tickRemainder = sim.clock.remainder;
+    snapshot.nextFireTick = sim.nextFireTick;
+    snapshot.nextAlienFireTick = sim.nextAlienFireTick;
+    snapshot.rngState = sim.rng.state;
+    snapshot.rngIncrement = sim.rng.increment;
+    snapshot.ship = sim.ship;
+
+    snapshot.rows = formation.rows;
+    snapshot.columns = formation.columns;
+    snapshot.spacing = formation.spacing;
+    snapshot.alive = formation.alive.empty() ? 0 : formation.alive[0];
+    snapshot.dying = formation.dying.empty() ? 0 : formation.dying[0];
+    for (int i = 0; i < formation.size(); i++) {
+        snapshot.alienX[i] = formation.x[i];
+        snapshot.alienY[i] = formation.y[i];
+        snapshot.deathFrame[i] = formation.deathFrame[i];
+        snapshot.deathTick[i] = formation.deathTick[i];
+    }
+    snapshot.walkFrame = formation.walkFrame;
+    snapshot.walkTick = formation.walkTick;
+    snapshot.shooterCount = static_cast<std::uint8_t>(formation.shooterCount());
+    for (int i = 0; i < formation.shooterCount(); i++) {
+        snapshot.shooterColumns[i] = static_cast<std::uint8_t>(formation.shooterColumns[i]);
+    }
+
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        std::memcpy(snapshot.bunkers[i], sim.bunkers[i].rows, sizeof(snapshot.bunkers[i]));
+    }
+    capturePool(sim.playerBolts, snapshot.playerBolts);
+    capturePool(sim.alienBolts, snapshot.alienBolts);
+    return true;
+}
+
+void restoreSnapshot(const GameSnapshot& snapshot, Simulation& sim) {
+    sim.gameState = static_cast<GameState>(snapshot.gameState);
+    sim.direction = static_cast<Direction>(snapshot.direction);
+    sim.moveDown = snapshot.moveDown != 0;
+    sim.fireLatch = snapshot.fireLatch != 0;
+    sim.lives = snapshot.lives;
+    sim.score = snapshot.score;
+    sim.wave = snapshot.wave;
+    sim.alienSpeed = snapshot.alienSpeed;
+    sim.alienBoltSpeed = snapshot.alienBoltSpeed;
+    sim.worldWidth = snapshot.worldWidth;
+    sim.worldHeight = snapshot.worldHeight;
+    sim.barrierY = snapshot.barrierY;
+    sim.formationRows = snapshot.formationRows;
+    sim.formationColumns = snapshot.formationColumns;
+    sim.maxPlayerBolts = snapshot.maxPlayerBolts;
+    sim.clock.tick = snapshot.tick;
+    sim.clock.remainder = snapshot.tickRemainder;
+    sim.nextFireTick = snapshot.nextFireTick;
+    sim.nextAlienFireTick = snapshot.nextAlienFireTick;
+    sim.rng.state = snapshot.rngState;
+    sim.rng.increment = snapshot.rngIncrement;
+    sim.ship = snapshot.ship;
+
+    Formation& formation = sim.formation;
+    formation.reset(snapshot.rows, snapshot.columns, 0.0f, 0.0f, snapshot.spacing, snapshot.walkTick);
+    if (!formation.alive.empty()) {
+        formation.alive[0] = snapshot.alive;
+        formation.dying[0] = snapshot.dying;
+    }
+    for (int i = 0; i < formation.size(); i++) {
+        formation.x[i] = snapshot.alienX[i];
+        formation.y[i] = snapshot.alienY[i];
+        formation.deathFrame[i] = snapshot.deathFrame[i];
+        formation.deathTick[i] = snapshot.deathTick[i];
+    }
+    formation.walkFrame = snapshot.walkFrame;
+    formation.shooterColumns.resize(snapshot.shooterCount);
+    for (int i = 0; i < snapshot.shooterCount; i++) {
+        formation.shooterColumns[i] = snapshot.shooterColumns[i];
+    }
+    formation.recount();
+
+    sim.boltGrid.reset(sim.worldWidth, sim.worldHeight, 64.0f);
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        std::memcpy(sim.bunkers[i].rows, snapshot.bunkers[i], sizeof(snapshot.bunkers[i]));
+    }
+    restorePool(snapshot.playerBolts, sim.playerBolts);
+    restorePool(snapshot.alienBolts, sim.alienBolts);
+    sim.events.clear();
+}
+
+// The live prefix of dense must be in range and a permutation of the pool's
+// slots; restorePool() rebuilds the sparse side from it.
+template <class Pool>
+static bool validPool(const PoolSnapshot& snapshot) {
+    if (snapshot.count > Pool::capacity()) return false;
+    bool seen[SNAPSHOT_BOLTS] = {};
+    for (int i = 0; i < Pool::capacity(); i++) {
+        int index = snapshot.dense[i];
+        if (index >= Pool::capacity() || seen[index]) return false;
+        seen[index] = true;
+    }
+    return true;
+}
+
+// Everything restoreSnapshot() uses as a size or an index, checked before a
+// file from disk gets near a Simulation.
+static bool validSnapshot(const GameSnapshot& snapshot) {
+    if (snapshot.gameState > WINNER_STATE || snapshot.direction > Down) return false;
+    // Written this way round so NaN fails too.
+    const float extents[] = { snapshot.worldWidth, snapshot.worldHeight, snapshot.barrierY };
+    for (float extent : extents) {
+        if (!(extent > 0.0f && extent <= SNAPSHOT_MAX_WORLD)) return false;
+    }
+    if (snapshot.rows < 0 || snapshot.columns < 0 || snapshot.columns > SNAPSHOT_MAX_COLUMNS) return false;
+    if (static_cast<std::int64_t>(snapshot.rows) * snapshot.columns > SNAPSHOT_MAX_ALIENS) return false;
+    if (snapshot.rows > 0 && snapshot.columns == 0) return false;
+    int slots = snapshot.rows * snapshot.columns;
+    if (snapshot.formationRows < 0 || snapshot.formationColumns < 0) return false;
+    if (static_cast<std::int64_t>(snapshot.formationRows) * snapshot.formationColumns > SNAPSHOT_MAX_ALIENS) return false;
+
+    std::uint64_t slotBits = slots == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << slots) - 1;
+    if ((snapshot.alive | snapshot.dying) & ~slotBits) return false;
+    for (int i = 0; i < slots; i++) {
+        if ((snapshot.dying >> i & 1) && snapshot.deathFrame[i] >= ALIEN_DEATH_FRAMES) return false;
+    }
+    if (snapshot.walkFrame < 0 || snapshot.walkFrame >= ALIEN_MOVE_FRAMES) return false;
+    if (snapshot.ship.currentFrame < 0) return false;
+
+    // The shooters must be exactly the columns with a living alien: a listed
+    // column without one would make its shooter slot row -1.
+    std::uint64_t living = 0;
+    for (int i = 0; i < slots; i++) {
+        if (snapshot.alive >> i & 1) living |= std::uint64_t(1) << (i % snapshot.columns);
+    }
+    if (snapshot.shooterCount > snapshot.columns) return false;
+    std::uint64_t shooters = 0;
+    for (int i = 0; i < snapshot.shooterCount; i++) {
+        int column = snapshot.shooterColumns[i];
+        if (column >= snapshot.columns || (shooters >> column & 1)) return false;
+        shooters |= std::uint64_t(1) << column;
+    }
+    if (shooters != living) return false;
+
+    return validPool<decltype(Simulation::playerBolts)>(snapshot.playerBolts) &&
+        validPool<decltype(Simulation::alienBolts)>(snapshot.alienBolts);
+}
+
+bool saveSnapshot(const std::string& path, const GameSnapshot& snapshot) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    std::uint32_t header[3] = { 0x53564e49u, SNAPSHOT_VERSION, static_cast<std::uint32_t>(sizeof(snapshot)) };
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&snapshot), sizeof(snapshot));
+    return static_cast<bool>(file);
+}
+
+bool loadSnapshot(const std::string& path, GameSnapshot& snapshot) {
+    std::ifstream file(path, std::ios::binary);
+    std::uint32_t header[3];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+    if (header[0] != 0x53564e49u || header[1] != SNAPSHOT_VERSION || header[2] != sizeof(snapshot)) return false;
+    return file.read(reinterpret_cast<char*>(&snapshot), sizeof(snapshot)) && validSnapshot(snapshot);
+}
+
+// Delta format: repeated [zero run][literal run][literal bytes], each run a
+// LEB128 count of bytes; the XOR of identical snapshots is one zero run.
+static std::size_t encodedBound() {
+    return sizeof(GameSnapshot) + sizeof(GameSnapshot) / 64 * 4 + 16;
+}
+
+static void putCount(std::uint8_t*& out, std::size_t value) {
+    do {
+        std::uint8_t byte = value & 0x7f;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        *out++ = byte;
+    } while (value);
+}
+
+static std::size_t getCount(const std::uint8_t*& in) {
+    std::size_t value = 0;
+    int shift = 0;
+    std::uint8_t byte;
+    do {
+        byte = *in++;
+        value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+// Encodes current XOR base; base may be null for a keyframe.
+static std::size_t encode(const GameSnapshot* base, const GameSnapshot& current, std::uint8_t* out) {
+    const std::uint8_t* a = reinterpret_cast<const std::uint8_t*>(base);
+    const std::uint8_t* b = reinterpret_cast<const std::uint8_t*>(&current);
+    const std::size_t size = sizeof(GameSnapshot);
+    std::uint8_t* start = out;
+
+    std::size_t i = 0;
+    while (i < size) {
+        std::size_t zeros = i;
+        while (zeros < size && (a ? a[zeros] ^ b[zeros] : b[zeros]) == 0) zeros++;
+        std::size_t literals = zeros;
+        // A literal run ends at the first stretch of four unchanged bytes.
+        while (literals < size) {
+            std::size_t probe = literals;
+            while (probe < size && probe < literals + 4 && (a ? a[probe] ^ b[probe] : b[probe]) == 0) probe++;
+            if (probe == size || probe == literals + 4) break;
+            literals = probe + 1;
+        }
+        putCount(out, zeros - i);
+        putCount(out, literals - zeros);
+        for (std::size_t j = zeros; j < literals; j++) {
+            *out++ = a ? a[j] ^ b[j] : b[j];
+        }
+        i = literals;
+        if (zeros == size) break;
+    }
+    return out - start;
+}
+
+static void apply(const std::uint8_t* in, std::size_t length, GameSnapshot& snapshot) {
+    std::uint8_t* target = reinterpret_cast<std::uint8_t*>(&snapshot);
+    const std::uint8_t* end = in + length;
+    std::size_t position = 0;
+    while (in < end) {
+        position += getCount(in);
+        std::size_t literals = getCount(in);
+        for (std::size_t j = 0; j < literals; j++) {
+            target[position++] ^= *in++;
+        }
+    }
+}
+
+RewindBuffer::RewindBuffer(std::size_t byteBudget, int tickLimit, int keyframeTicks)
+    : maxTicks(std::max(tickLimit, 1)), keyframeInterval(std::max(keyframeTicks, 1)) {
+    // Room for at least two keyframes, so dropping one never empties the buffer.
+    bytes.resize(std::max(byteBudget, encodedBound() * 2));
+    records.resize(maxTicks);
+    clear();
+}
+
+void RewindBuffer::clear() {
+    first = 0;
+    count = 0;
+    sinceKeyframe = 0;
+    writeOffset = 0;
+}
+
+void RewindBuffer::dropOldest() {
+    do {
+        first = (first + 1) % maxTicks;
+        count--;
+    } while (count > 0 && !records[first].keyframe);
+}
+
+// Finds room for the next record, wrapping to the start of the byte ring and
+// dropping old records that overlap the space.
+bool RewindBuffer::reserve(std::size_t size, std::size_t& offset) {
+    if (size > bytes.size()) return false;
+    // Records past the cursor are the oldest; wrapping skips the tail, so
+    // anything still there goes too.
+    std::size_t skipped = bytes.size();
+    if (writeOffset + size > bytes.size()) {
+        skipped = writeOffset;
+        writeOffset = 0;
+    }
+    offset = writeOffset;
+
+    while (count > 0) {
+        const Record& oldest = records[first];
+        bool stale = oldest.offset >= skipped;
+        bool overlaps = oldest.offset < offset + size && offset < oldest.offset + oldest.size;
+        if (!stale && !overlaps && count < maxTicks) break;
+        dropOldest();
+    }
+    writeOffset = offset + size;
+    return true;
+}
+
+void RewindBuffer::push(const GameSnapshot& snapshot) {
+    // Room for the worst case is reserved first; the record then shrinks to
+    // what the encoder actually wrote.
+    std::size_t offset;
+    if (!reserve(encodedBound(), offset)) return;
+
+    // Reserving may have dropped the keyframe the delta would depend on.
+    bool keyframe = count == 0 || sinceKeyframe + 1 >= keyframeInterval;
+    std::size_t size = encode(keyframe ? nullptr : &last, snapshot, bytes.data() + offset);
+    writeOffset = offset + size;
+
+    int index = (first + count) % maxTicks;
+    records[index].offset = offset;
+    records[index].size = static_cast<std::uint32_t>(size);
+    records[index].keyframe = keyframe;
+    count++;
+    sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+    last = snapshot;
+}
+
+void RewindBuffer::decode(int index, GameSnapshot& snapshot) {
+    int key = index;
+    while (!records[(first + key) % maxTicks].keyframe) key--;
+
+    std::memset(static_cast<void*>(&snapshot), 0, sizeof(snapshot));
+    for (int i = key; i <= index; i++) {
+        const Record& record = records[(first + i) % maxTicks];
+        apply(bytes.data() + record.offset, record.size, snapshot);
+    }
+}
+
+bool RewindBuffer::rewind(int ticks, GameSnapshot& snapshot) {
+    if (count == 0) return false;
+    int target = std::max(count - 1 - std::max(ticks, 0), 0);
+    decode(target, snapshot);
+
+    count = target + 1;
+    const Record& newest = records[(first + target) % maxTicks];
+    writeOffset = newest.offset + newest.size;
+    sinceKeyframe = 0;
+    for (int i = target; i >= 0 && !records[(first + i) % maxTicks].keyframe; i--) {
+        sinceKeyframe++;
+    }
+    last = snapshot;
+    return true;
+}
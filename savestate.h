@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+const int SNAPSHOT_MAX_ALIENS = 64;
+const int SNAPSHOT_MAX_COLUMNS = 64;
+const int SNAPSHOT_BOLTS = 256;
+// Largest world width, height or barrier line a snapshot may carry; it bounds
+// the bolt grid a restored game allocates.
+const float SNAPSHOT_MAX_WORLD = 16384.0f;
+
+// Live bolts in pool order plus the pool's full slot order, so a restored
+// pool hands out the same slot indices as the original would have.
+struct PoolSnapshot {
+    std::uint16_t count;
+    std::uint8_t dense[SNAPSHOT_BOLTS];
+    Bolt bolts[SNAPSHOT_BOLTS];
+};
+
+// Every piece of gameplay state in one trivially copyable block. Derived
+// data (formation counts and edges, the broadphase grid, last step's events)
+// is left out and rebuilt on restore. Unused array tails stay zero, which is
+// what makes consecutive snapshots cheap to delta-compress.
+struct GameSnapshot {
+    std::uint32_t gameState;
+    std::uint32_t direction;
+    std::uint8_t moveDown;
+    std::uint8_t fireLatch;
+    std::int32_t lives;
+    std::int32_t score;
+    std::int32_t wave;
+    float alienSpeed;
+    float alienBoltSpeed;
+    float worldWidth;
+    float worldHeight;
+    float barrierY;
+    std::int32_t formationRows;
+    std::int32_t formationColumns;
+    std::int32_t maxPlayerBolts;
+    std::uint32_t tick;
+    float tickRemainder;
+    std::uint32_t nextFireTick;
+    std::uint32_t nextAlienFireTick;
+    std::uint64_t rngState;
+    std::uint64_t rngIncrement;
+    Ship ship;
+
+    std::int32_t rows;
+    std::int32_t columns;
+    float spacing;
+    std::uint64_t alive;
+    std::uint64_t dying;
+    float alienX[SNAPSHOT_MAX_ALIENS];
+    float alienY[SNAPSHOT_MAX_ALIENS];
+    std::uint8_t deathFrame[SNAPSHOT_MAX_ALIENS];
+    std::uint32_t deathTick[SNAPSHOT_MAX_ALIENS];
+    std::int32_t walkFrame;
+    std::uint32_t walkTick;
+    std::uint8_t shooterCount;
+    std::uint8_t shooterColumns[SNAPSHOT_MAX_COLUMNS];
+
+    std::uint64_t bunkers[BUNKER_COUNT][BUNKER_HEIGHT];
+    PoolSnapshot playerBolts;
+    PoolSnapshot alienBolts;
+};
+
+// Fails only for formations larger than a snapshot holds (modded builds).
+bool captureSnapshot(const Simulation& sim, GameSnapshot& snapshot);
+void restoreSnapshot(const GameSnapshot& snapshot, Simulation& sim);
+
+bool saveSnapshot(const std::string& path, const GameSnapshot& snapshot);
+// Rejects files that are short, from another version or hold sizes and
+// indices restoreSnapshot() could not use safely.
+bool loadSnapshot(const std::string& path, GameSnapshot& snapshot);
+
+// The last few seconds of play, one snapshot per tick. Every keyframeInterval
+// ticks a full snapshot is stored; the ticks between store the XOR against the
+// previous snapshot, run-length encoded, which is usually a few dozen bytes.
+// All memory is reserved up front: when either the byte budget or the tick
+// limit runs out, the oldest keyframe and its deltas are dropped together.
+struct RewindBuffer {
+    struct Record {
+        std::size_t offset;
+        std::uint32_t size;
+        bool keyframe;
+    };
+
+    std::vector<std::uint8_t> bytes;
+    std::vector<Record> records;
+    int first = 0;
+    int count = 0;
+    int maxTicks = 0;
+    int keyframeInterval = 0;
+    int sinceKeyframe = 0;
+    std::size_t writeOffset = 0;
+    GameSnapshot last;
+
+    RewindBuffer(std::size_t byteBudget, int tickLimit, int keyframeTicks = 60);
+
+    void clear();
+    void push(const GameSnapshot& snapshot);
+    // Steps back up to ticks snapshots, drops everything newer and writes the
+    // one it landed on. Returns false when the buffer is empty.
+    bool rewind(int ticks, GameSnapshot& snapshot);
+    int size() const { return count; }
+
+private:
+    void dropOldest();
+    bool reserve(std::size_t size, std::size_t& offset);
+    void decode(int index, GameSnapshot& snapshot);
+};
@@ -0,0 +1,58 @@
+#include "sfmlaudio.h"
+
+void SfmlAudioBackend::play(int voice, int effect) {
+    if (!buffers[effect]) return;
+    voices[voice].setBuffer(*buffers[effect]);
+    voices[voice].play();
+}
+
+void SfmlAudioBackend::stop(int voice) {
+    voices[voice].stop();
+}
+
+void loadSoundEffects(Mixer& mixer, SfmlAudioBackend& backend, const Resources& resources) {
+    struct Setting {
+        SoundId id;
+        int maxVoices;
+        int priority;
+    };
+    const Setting settings[] = {
+        { SOUND_SHIP_BOLT, 2, 1 },
+        { SOUND_ALIEN_DESTROYED, 4, 2 },
+        { SOUND_BOLT_DESTROYED, 2, 2 },
+        { SOUND_SHIP_DAMAGE, 1, 3 },
+    };
+
+    for (const auto& setting : settings) {
+        const sf::SoundBuffer& buffer = getSound(resources, setting.id);
+        backend.buffers[setting.id] = &buffer;
+
+        EffectConfig config;
+        config.duration = buffer.getDuration().asSeconds();
+        config.maxVoices = setting.maxVoices;
+        config.priority = setting.priority;
+        mixer.setEffect(setting.id, config);
+    }
+}
+
+void postSounds(const Simulation& sim, Mixer& mixer) {
+    for (GameEvent event : sim.events) {
+        switch (event) {
+            case EVENT_SHIP_FIRED:
+                mixer.post(SOUND_SHIP_BOLT);
+                break;
+            case EVENT_ALIEN_DESTROYED:
+                mixer.post(SOUND_ALIEN_DESTROYED);
+                break;
+            case EVENT_BOLT_DESTROYED:
+                mixer.post(SOUND_BOLT_DESTROYED);
+                break;
+            case EVENT_SHIP_DAMAGED:
+                mixer.post(SOUND_SHIP_DAMAGE);
+                break;
+            case EVENT_BUNKER_HIT:
+                mixer.post(SOUND_BOLT_DESTROYED);
+                break;
+        }
+    }
+}
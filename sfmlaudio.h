@@ -0,0 +1,19 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include "mixer.h"
+#include "resources.h"
+#include "simulation.h"
+
+struct SfmlAudioBackend : AudioBackend {
+    sf::Sound voices[MIXER_VOICES];
+    const sf::SoundBuffer* buffers[MIXER_EFFECTS] = {};
+
+    void play(int voice, int effect) override;
+    void stop(int voice) override;
+};
+
+// Binds every SoundId to its buffer and sets its polyphony and priority.
+void loadSoundEffects(Mixer& mixer, SfmlAudioBackend& backend, const Resources& resources);
+
+// Queues the sound for every event the last step produced.
+void postSounds(const Simulation& sim, Mixer& mixer);
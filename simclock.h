@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+const int TICKS_PER_SECOND = 120;
+const float TICK_SECONDS = 1.0f / TICKS_PER_SECOND;
+
+inline std::uint32_t secondsToTicks(float seconds) {
+    return static_cast<std::uint32_t>(seconds * TICKS_PER_SECOND + 0.5f);
+}
+
+// Game time in whole ticks. Only advanced while the game is being played, so
+// every timer measured against it stops when the game is paused and replays
+// identically for the same sequence of steps. Timers store the tick they
+// started on and compare with unsigned subtraction, which survives wrap-around.
+struct SimClock {
+    std::uint32_t tick = 0;
+    float remainder = 0.0f;
+
+    std::uint32_t advance(float dt) {
+        remainder += dt * TICKS_PER_SECOND;
+        std::uint32_t ticks = static_cast<std::uint32_t>(remainder);
+        remainder -= ticks;
+        tick += ticks;
+        return ticks;
+    }
+
+    std::uint32_t since(std::uint32_t start) const {
+        return tick - start;
+    }
+
+    bool reached(std::uint32_t deadline) const {
+        return static_cast<std::int32_t>(tick - deadline) >= 0;
+    }
+};
@@ -0,0 +1,74 @@
+#include "simthread.h"
+#include <algorithm>
+#include "sfmlaudio.h"
+
+// Catch-up limit, matching the single-threaded loop: a stall longer than this
+// is dropped rather than simulated in a burst.
+const std::chrono::milliseconds MAX_TICK_LAG(250);
+
+SimulationThread::SimulationThread(const Simulation& initial, Mixer& tickMixer, InputRecorder* inputRecorder, InputReplay* inputReplay)
+    : mixer(tickMixer), recorder(inputRecorder), replay(inputReplay) {
+    // Assigned rather than copy-constructed so the reserved buffers survive.
+    sim = initial;
+    SimSnapshot& first = snapshots.back();
+    first.previous = sim;
+    first.current = sim;
+    first.time = std::chrono::steady_clock::now();
+    snapshots.publish();
+}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    running = true;
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+}
+
+void SimulationThread::submit(const InputFrame& held, const InputFrame& presses) {
+    heldKeys.store(packInput(held));
+    pressedKeys.fetch_or(packInput(presses));
+}
+
+void SimulationThread::run() {
+    typedef std::chrono::steady_clock Clock;
+    const auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(TICK_SECONDS));
+
+    Simulation previous;
+    previous = sim;
+    Clock::time_point next = Clock::now();
+
+    while (running) {
+        InputFrame input = unpackInput(heldKeys.load() | pressedKeys.exchange(0));
+        if (replay && !replay->next(input)) {
+            finished = true;
+            break;
+        }
+        if (recorder) recorder->record(input);
+
+        previous = sim;
+        sim.step(input, TICK_SECONDS);
+        postSounds(sim, mixer);
+        if (telemetry) telemetry->recordStep(sim);
+        mixer.update(TICK_SECONDS);
+        PROFILE_FLUSH(profileTotals);
+
+        Clock::time_point now = Clock::now();
+        SimSnapshot& snapshot = snapshots.back();
+        snapshot.previous = previous;
+        snapshot.current = sim;
+        snapshot.time = now;
+        std::copy(profileTotals, profileTotals + PROFILE_SECTION_COUNT, snapshot.profileTotals);
+        snapshots.publish();
+
+        next += tickLength;
+        if (now - next > MAX_TICK_LAG) next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
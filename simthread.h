@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "mixer.h"
+#include "profiler.h"
+#include "replay.h"
+#include "simulation.h"
+#include "telemetry.h"
+#include "triplebuffer.h"
+
+// One published tick: the state before and after it, and when it was taken,
+// so the render side can interpolate without touching the live simulation.
+// profileTotals are the simulation thread's section times so far; the render
+// side merges what they gained into its own profiler, because snapshots it
+// never acquires are skipped.
+struct SimSnapshot {
+    Simulation previous;
+    Simulation current;
+    std::chrono::steady_clock::time_point time;
+    std::uint64_t profileTotals[PROFILE_SECTION_COUNT] = {};
+};
+
+// Runs the fixed-step simulation on its own thread. The window thread hands
+// over input with submit() and draws whatever snapshots.acquire() gives it;
+// nothing the two threads share is behind a lock. The simulation thread also
+// owns recording, replay and the mixer, so sounds keep their tick timing.
+struct SimulationThread {
+    Simulation sim;
+    Mixer& mixer;
+    InputRecorder* recorder;
+    InputReplay* replay;
+    // Fed from this thread's ring; the window thread records frames only.
+    Telemetry* telemetry = nullptr;
+    TripleBuffer<SimSnapshot> snapshots;
+    std::uint64_t profileTotals[PROFILE_SECTION_COUNT] = {};
+    std::atomic<std::uint8_t> heldKeys{ 0 };
+    std::atomic<std::uint8_t> pressedKeys{ 0 };
+    std::atomic<bool> running{ false };
+    std::atomic<bool> finished{ false };
+    std::thread thread;
+
+    SimulationThread(const Simulation& initial, Mixer& tickMixer, InputRecorder* inputRecorder, InputReplay* inputReplay);
+    ~SimulationThread();
+
+    void start();
+    // Joins the thread; sim holds the final state afterwards.
+    void stop();
+    // held is what is down now and replaces the last one; presses are only
+    // the new presses and wait for the next tick even when several frames
+    // submit before it runs.
+    void submit(const InputFrame& held, const InputFrame& presses);
+
+private:
+    void run();
+};
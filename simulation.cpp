@@ -0,0 +1,392 @@
+#include "simulation.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+
+const float SHIP_SPEED = 200.0f;
+const float BOLT_SPEED = 300.0f;
+const std::uint32_t FIRE_COOLDOWN_TICKS = secondsToTicks(0.5f);
+const std::uint32_t ALIEN_MOVEMENT_FRAME_TICKS = secondsToTicks(0.5f);
+const std::uint32_t ALIEN_DEATH_FRAME_TICKS = secondsToTicks(0.05f);
+const std::uint32_t SHIP_DEATH_FRAME_TICKS = secondsToTicks(0.3f);
+const float ALIEN_DROP = 20.0f;
+
+// One alien shot in flight on the first waves, one more every four waves.
+static int alienBoltLimit(int wave) {
+    return 1 + (wave - 1) / 4;
+}
+
+// Six seconds between alien shots on the first wave, 0.4 s less each wave after.
+static std::uint32_t alienFireInterval(int wave) {
+    return secondsToTicks(std::max(6.0f - 0.4f * (wave - 1), 1.5f));
+}
+
+static Rect shipRect(const Ship& ship) {
+    return { ship.x, ship.y, SHIP_SIZE, SHIP_SIZE };
+}
+
+static Rect boltRect(float x, float y) {
+    return { x, y, BOLT_WIDTH, BOLT_HEIGHT };
+}
+
+
+
+// Spreads the bunkers evenly across the arena just above the barrier line.
+static void resetBunkers(Simulation& sim) {
+    float top = sim.barrierY - BUNKER_HEIGHT - 12.0f;
+    for (int i = 0; i < BUNKER_COUNT; i++) {
+        float center = sim.worldWidth * (i + 0.5f) / BUNKER_COUNT;
+        sim.bunkers[i].reset(std::floor(center - BUNKER_WIDTH / 2), top);
+    }
+}
+
+static void startWave(Simulation& sim) {
+    sim.formation.reset(sim.formationRows, sim.formationColumns, 100.0f, 50.0f, ALIEN_SPACING, sim.clock.tick);
+    sim.boltGrid.reset(sim.worldWidth, sim.worldHeight, 64.0f);
+    sim.ship.x = SHIP_START_X;
+    sim.ship.y = SHIP_START_Y;
+    sim.playerBolts.clear();
+    sim.alienBolts.clear();
+    resetBunkers(sim);
+    sim.nextAlienFireTick = sim.clock.tick + alienFireInterval(sim.wave);
+    sim.direction = Right;
+    sim.moveDown = false;
+}
+
+static void startGame(Simulation& sim) {
+    sim.ship = Ship();
+    sim.lives = START_LIVES;
+    sim.score = 0;
+    sim.alienSpeed = 50.0f;
+    sim.alienBoltSpeed = 100.0f;
+    sim.wave = 1;
+    sim.fireLatch = false;
+    startWave(sim);
+}
+
+static void shipMovement(Simulation& sim, const InputFrame& input, float time) {
+    PROFILE_SCOPE(PROFILE_SHIP_MOVEMENT);
+    Ship& ship = sim.ship;
+    if (input.moveUp) {
+        ship.y -= SHIP_SPEED * time;
+    }
+    if (input.moveLeft) {
+        ship.x -= SHIP_SPEED * time;
+    }
+    if (input.moveDown) {
+        ship.y += SHIP_SPEED * time;
+    }
+    if (input.moveRight) {
+        ship.x += SHIP_SPEED * time;
+    }
+
+    ship.x = std::max(ship.x, 0.0f);
+    ship.x = std::min(ship.x, sim.worldWidth - SHIP_SIZE);
+    ship.y = std::max(ship.y, sim.barrierY);
+    ship.y = std::min(ship.y, sim.worldHeight - SHIP_SIZE);
+}
+
+static void moveAliens(Simulation& sim, float time) {
+    PROFILE_SCOPE(PROFILE_MOVE_ALIENS);
+    Formation& formation = sim.formation;
+    if (formation.livingCount == 0) return;
+
+    if (sim.clock.since(formation.walkTick) >= ALIEN_MOVEMENT_FRAME_TICKS) {
+        formation.walkFrame = (formation.walkFrame + 1) % ALIEN_MOVE_FRAMES;
+        formation.walkTick = sim.clock.tick;
+    }
+
+    bool changeDirection = false;
+    if (sim.direction == Right) {
+        formation.translate(sim.alienSpeed * time, 0.0f);
+        if (formation.rightEdge() + ALIEN_SIZE > sim.worldWidth) {
+            changeDirection = true;
+        }
+    }
+    else if (sim.direction == Left) {
+        formation.translate(-sim.alienSpeed * time, 0.0f);
+        if (formation.leftEdge() < 0) {
+            changeDirection = true;
+        }
+    }
+    if (formation.bottomEdge() + ALIEN_SIZE >= sim.barrierY) {
+        sim.gameState = DEFEAT_STATE;
+    }
+
+    if (changeDirection) {
+        sim.direction = (sim.direction == Right) ? Left : Right;
+        sim.moveDown = true;
+    }
+
+    if (sim.moveDown) {
+        formation.translate(0.0f, ALIEN_DROP);
+        sim.moveDown = false;
+    }
+}
+
+static void fireBolt(Simulation& sim, const InputFrame& input, float time) {
+    PROFILE_SCOPE(PROFILE_FIRE_BOLT);
+    if (sim.ship.isDying) {
+        sim.fireLatch = false;
+        return;
+    }
+
+    // Only presses shoot; holding fire down does not repeat.
+    sim.fireLatch = sim.fireLatch || input.firePressed;
+    if (sim.fireLatch && sim.playerBolts.count < sim.maxPlayerBolts && sim.clock.reached(sim.nextFireTick)) {
+        Bolt bolt;
+        bolt.x = sim.ship.x + SHIP_SIZE / 2 - BOLT_WIDTH / 2;
+        bolt.y = sim.ship.y;
+        if (sim.playerBolts.spawn(bolt) >= 0) {
+            sim.events.push_back(EVENT_SHIP_FIRED);
+        }
+        sim.fireLatch = false;
+        sim.nextFireTick = sim.clock.tick + FIRE_COOLDOWN_TICKS;
+    }
+
+    sim.playerBolts.forEach([time](int, Bolt& bolt) {
+        bolt.y -= BOLT_SPEED * time;
+    });
+}
+
+static const CollisionMask* alienMask(const Simulation& sim) {
+    if (!sim.masks || sim.formation.walkFrame >= static_cast<int>(sim.masks->alien.size())) return nullptr;
+    return &sim.masks->alien[sim.formation.walkFrame];
+}
+
+static const CollisionMask* shipMask(const Simulation& sim) {
+    int frame = std::min(sim.ship.currentFrame, SHIP_DEATH_FRAMES - 1);
+    if (!sim.masks || frame >= static_cast<int>(sim.masks->ship.size())) return nullptr;
+    return &sim.masks->ship[frame];
+}
+
+static void alienBoltCollisions(Simulation& sim) {
+    PROFILE_SCOPE(PROFILE_ALIEN_COLLISIONS);
+    Formation& formation = sim.formation;
+    const CollisionMask* mask = alienMask(sim);
+
+    sim.playerBolts.forEach([&](int index, const Bolt& bolt) {
+        if (bolt.y + BOLT_HEIGHT < 0) {
+            sim.playerBolts.release(index);
+            return;
+        }
+        int slot = queryFormation(formation, boltRect(bolt.x, bolt.y), ALIEN_SIZE, mask);
+        if (slot >= 0) {
+            sim.playerBolts.release(index);
+            formation.kill(slot, sim.clock.tick);
+            sim.score += ALIEN_POINTS * (formation.rows - slot / formation.columns);
+            sim.events.push_back(EVENT_ALIEN_DESTROYED);
+        }
+    });
+}
+
+static void updateDyingAliens(Simulation& sim) {
+    PROFILE_SCOPE(PROFILE_CLEANUP);
+    Formation& formation = sim.formation;
+
+    forEachSlot(formation.dying, [&](int slot) {
+        if (sim.clock.since(formation.deathTick[slot]) >= ALIEN_DEATH_FRAME_TICKS) {
+            formation.deathFrame[slot]++;
+            if (formation.deathFrame[slot] >= ALIEN_DEATH_FRAMES) {
+                formation.remove(slot);
+            }
+            formation.deathTick[slot] = sim.clock.tick;
+        }
+    });
+}
+
+static void alienShootBolts(Simulation& sim, float time) {
+    PROFILE_SCOPE(PROFILE_ALIEN_FIRE);
+    const Formation& formation = sim.formation;
+
+    if (sim.alienBolts.count < alienBoltLimit(sim.wave) && sim.clock.reached(sim.nextAlienFireTick) && formation.shooterCount() > 0) {
+        int shooter = formation.shooterSlot(sim.rng.below(formation.shooterCount()));
+        Bolt bolt;
+        bolt.x = formation.x[shooter] + ALIEN_SIZE / 2;
+        bolt.y = formation.y[shooter] + ALIEN_SIZE;
+        sim.alienBolts.spawn(bolt);
+        sim.nextAlienFireTick = sim.clock.tick + alienFireInterval(sim.wave);
+    }
+
+    sim.alienBolts.forEach([&sim, time](int index, Bolt& bolt) {
+        bolt.y += sim.alienBoltSpeed * time;
+        if (bolt.y > sim.worldHeight) {
+            sim.alienBolts.release(index);
+        }
+    });
+}
+
+// Bolts from both sides blast holes where they strike; aliens low enough to
+// reach the bunkers erase whatever they walk through.
+static void bunkerCollisions(Simulation& sim) {
+    PROFILE_SCOPE(PROFILE_BUNKER_COLLISIONS);
+    const Formation& formation = sim.formation;
+    bool aliensLow = formation.livingCount > 0 && formation.bottomEdge() + ALIEN_SIZE > sim.bunkers[0].y;
+
+    for (Bunker& bunker : sim.bunkers) {
+        Rect bounds = bunker.bounds();
+
+        sim.alienBolts.forEach([&](int index, const Bolt& bolt) {
+            Rect rect = boltRect(bolt.x, bolt.y);
+            if (!intersects(rect, bounds)) return;
+            int row = bunker.firstSolidRow(bolt.x + BOLT_WIDTH / 2, bolt.y, BOLT_HEIGHT, true);
+            if (row < 0) return;
+            bunker.erode(bolt.x + BOLT_WIDTH / 2, row, true);
+            sim.alienBolts.release(index);
+            sim.events.push_back(EVENT_BUNKER_HIT);
+        });
+        sim.playerBolts.forEach([&](int index, const Bolt& bolt) {
+            Rect rect = boltRect(bolt.x, bolt.y);
+            if (!intersects(rect, bounds)) return;
+            int row = bunker.firstSolidRow(bolt.x + BOLT_WIDTH / 2, bolt.y, BOLT_HEIGHT, false);
+            if (row < 0) return;
+            bunker.erode(bolt.x + BOLT_WIDTH / 2, row, false);
+            sim.playerBolts.release(index);
+            sim.events.push_back(EVENT_BUNKER_HIT);
+        });
+
+        if (aliensLow) {
+            forEachSlot(formation.alive, [&](int slot) {
+                Rect alien = { formation.x[slot], formation.y[slot], ALIEN_SIZE, ALIEN_SIZE };
+                if (intersects(alien, bounds)) bunker.carve(alien);
+            });
+        }
+    }
+}
+
+static void shipBoltCollisions(Simulation& sim) {
+    PROFILE_SCOPE(PROFILE_SHIP_COLLISIONS);
+    Ship& ship = sim.ship;
+    const CollisionMask* mask = shipMask(sim);
+    sim.alienBolts.forEach([&](int index, const Bolt& bolt) {
+        Rect rect = boltRect(bolt.x, bolt.y);
+        if (!ship.isDying && intersects(rect, shipRect(ship)) && (!mask || maskOverlapsRect(*mask, ship.x, ship.y, rect))) {
+            sim.lives--;
+            sim.alienBolts.release(index);
+            sim.events.push_back(EVENT_SHIP_DAMAGED);
+            if (sim.lives <= 0) {
+                ship.isDying = true;
+            }
+            ship.currentFrame = 0;
+            ship.deathTick = sim.clock.tick;
+        }
+    });
+}
+
+static void boltCollisions(Simulation& sim) {
+    PROFILE_SCOPE(PROFILE_BOLT_COLLISIONS);
+    if (sim.alienBolts.count == 0 || sim.playerBolts.count == 0) return;
+
+    int ids[PLAYER_BOLT_CAPACITY];
+    int count = 0;
+    sim.playerBolts.forEach([&](int index, const Bolt&) {
+        ids[count++] = index;
+    });
+    sim.boltGrid.build(count, [&](int i) {
+        return boltRect(sim.playerBolts[ids[i]].x, sim.playerBolts[ids[i]].y);
+    });
+
+    sim.alienBolts.forEach([&](int index, const Bolt& bolt) {
+        sim.boltGrid.query(boltRect(bolt.x, bolt.y), [&](int i) {
+            if (!sim.playerBolts.isAlive(ids[i])) return false;
+            sim.playerBolts.release(ids[i]);
+            sim.alienBolts.release(index);
+            sim.events.push_back(EVENT_BOLT_DESTROYED);
+            return true;
+        });
+    });
+}
+
+static void shipDeathAnimation(Simulation& sim) {
+    Ship& ship = sim.ship;
+    if (ship.isDying) {
+        if (sim.clock.since(ship.deathTick) >= SHIP_DEATH_FRAME_TICKS) {
+            ship.currentFrame++;
+            if (ship.currentFrame >= SHIP_DEATH_FRAMES) {
+                ship.x = -100.0f;
+                ship.y = -100.0f;
+            }
+            ship.deathTick = sim.clock.tick;
+        }
+    }
+}
+
+static void playStep(Simulation& sim, const InputFrame& input, float time) {
+    sim.clock.advance(time);
+
+    moveAliens(sim, time);
+    alienBoltCollisions(sim);
+    updateDyingAliens(sim);
+    alienShootBolts(sim, time);
+    bunkerCollisions(sim);
+    shipBoltCollisions(sim);
+    boltCollisions(sim);
+    shipDeathAnimation(sim);
+    fireBolt(sim, input, time);
+    shipMovement(sim, input, time);
+
+    if (sim.ship.isDying && sim.ship.currentFrame >= SHIP_DEATH_FRAMES) {
+        if (sim.lives <= 0) {
+            sim.gameState = DEFEAT_STATE;
+        }
+        else {
+            sim.ship.isDying = false;
+            sim.ship.x = SHIP_START_X;
+            sim.ship.y = SHIP_START_Y;
+        }
+    }
+
+    if (sim.formation.empty()) {
+        sim.wave++;
+        sim.alienSpeed += 10.0f;
+        sim.alienBoltSpeed += 5.0f;
+        sim.direction = Right;
+        sim.gameState = sim.wave == FINAL_WAVE ? WINNER_STATE : NEXT_WAVE_STATE;
+    }
+}
+
+Simulation::Simulation(std::uint64_t seed) : rng(seed) {
+    // Every event but a shot consumes a live bolt, so this bounds one step.
+    events.reserve(PLAYER_BOLT_CAPACITY + ALIEN_BOLT_CAPACITY + 1);
+    boltGrid.reserve(PLAYER_BOLT_CAPACITY);
+    reset();
+}
+
+void Simulation::reset() {
+    startGame(*this);
+    gameState = BEGINNING_STATE;
+    events.clear();
+}
+
+void Simulation::step(const InputFrame& input, float dt) {
+    events.clear();
+
+    switch (gameState) {
+        case BEGINNING_STATE:
+            if (input.start) gameState = PLAY_STATE;
+            break;
+        case PLAY_STATE:
+            if (input.pause) gameState = PAUSE_STATE;
+            break;
+        case PAUSE_STATE:
+            if (input.pause) gameState = PLAY_STATE;
+            break;
+        case NEXT_WAVE_STATE:
+            if (input.start) {
+                startWave(*this);
+                gameState = PLAY_STATE;
+            }
+            break;
+        case WINNER_STATE:
+        case DEFEAT_STATE:
+            if (input.start) {
+                startGame(*this);
+                gameState = PLAY_STATE;
+            }
+            break;
+    }
+
+    if (gameState == PLAY_STATE) {
+        playStep(*this, input, dt);
+    }
+}
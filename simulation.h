@@ -0,0 +1,127 @@
+#pragma once
+#include <vector>
+#include "bunker.h"
+#include "collision.h"
+#include "formation.h"
+#include "pool.h"
+#include "rng.h"
+#include "simclock.h"
+
+enum GameState {
+    BEGINNING_STATE,
+    PLAY_STATE,
+    PAUSE_STATE,
+    DEFEAT_STATE,
+    NEXT_WAVE_STATE,
+    WINNER_STATE,
+};
+
+enum Direction {
+    Left,
+    Right,
+    Down
+};
+
+enum GameEvent {
+    EVENT_SHIP_FIRED,
+    EVENT_ALIEN_DESTROYED,
+    EVENT_BOLT_DESTROYED,
+    EVENT_SHIP_DAMAGED,
+    EVENT_BUNKER_HIT,
+};
+
+const float WORLD_WIDTH = 800.0f;
+const float WORLD_HEIGHT = 600.0f;
+const float BARRIER_Y = 428.0f;
+const float ALIEN_SIZE = 36.0f;
+const float ALIEN_SPACING = 60.0f;
+const float SHIP_SIZE = 44.0f;
+const float SHIP_START_X = 400.0f;
+const float SHIP_START_Y = 500.0f;
+const float BOLT_WIDTH = 8.0f;
+const float BOLT_HEIGHT = 30.0f;
+const int ALIEN_ROWS = 3;
+const int ALIEN_COLUMNS = 10;
+const int ALIEN_MOVE_FRAMES = 2;
+const int ALIEN_DEATH_FRAMES = 4;
+const int SHIP_DEATH_FRAMES = 6;
+const int MAX_PLAYER_BOLTS = 3;
+const int PLAYER_BOLT_CAPACITY = 256;
+const int ALIEN_BOLT_CAPACITY = 256;
+const int START_LIVES = 3;
+// Points for an alien in the bottom row; each row above is worth this much more.
+const int ALIEN_POINTS = 10;
+const int FINAL_WAVE = 12;
+
+struct Ship {
+    float x = SHIP_START_X;
+    float y = SHIP_START_Y;
+    bool isDying = false;
+    int currentFrame = 0;
+    std::uint32_t deathTick = 0;
+};
+
+struct Bolt {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+// Held keys plus the one-shot presses that drive the menu transitions. The
+// front end fills one of these per step; the simulation never polls a device.
+struct InputFrame {
+    bool moveUp = false;
+    bool moveDown = false;
+    bool moveLeft = false;
+    bool moveRight = false;
+    bool fire = false;
+    // Fire went down since the last tick; each press is one shot. A press the
+    // cooldown holds back is kept and fires as soon as it can.
+    bool firePressed = false;
+    bool start = false;
+    bool pause = false;
+};
+
+// All gameplay state, advanced only through step(). Nothing in here touches a
+// window, a clock or an audio device, so it runs the same with or without a
+// display attached.
+struct Simulation {
+    GameState gameState = BEGINNING_STATE;
+    // Arena and formation layout. The defaults are the 800x600 game; larger
+    // values are for modded builds and benchmarks and apply from the next wave.
+    float worldWidth = WORLD_WIDTH;
+    float worldHeight = WORLD_HEIGHT;
+    float barrierY = BARRIER_Y;
+    int formationRows = ALIEN_ROWS;
+    int formationColumns = ALIEN_COLUMNS;
+    Formation formation;
+    Ship ship;
+    Pool<Bolt, PLAYER_BOLT_CAPACITY> playerBolts;
+    Pool<Bolt, ALIEN_BOLT_CAPACITY> alienBolts;
+    Bunker bunkers[BUNKER_COUNT];
+    int maxPlayerBolts = MAX_PLAYER_BOLTS;
+    Direction direction = Right;
+    bool moveDown = false;
+    int lives = START_LIVES;
+    int score = 0;
+    float alienSpeed = 50.0f;
+    float alienBoltSpeed = 100.0f;
+    int wave = 1;
+    SimClock clock;
+    std::uint32_t nextFireTick = 0;
+    std::uint32_t nextAlienFireTick = 0;
+    // A fire press still waiting for the cooldown or a free bolt.
+    bool fireLatch = false;
+    Rng rng;
+    UniformGrid boltGrid;
+    // Pixel masks for the narrow phase; owned by the caller. Without them
+    // hits are decided by rectangles alone.
+    const SpriteMasks* masks = nullptr;
+
+    // Sound-worthy things that happened during the last step.
+    std::vector<GameEvent> events;
+
+    explicit Simulation(std::uint64_t seed = 1);
+
+    void reset();
+    void step(const InputFrame& input, float dt);
+};
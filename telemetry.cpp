@@ -0,0 +1,182 @@
+#include "telemetry.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static const char* const typeNames[TELEMETRY_TYPE_COUNT] = {
+    "state",
+    "waveStarted",
+    "waveCleared",
+    "kills",
+    "lifeLost",
+    "frame",
+    "dropped",
+};
+
+const char* telemetryTypeName(int type) {
+    return type >= 0 && type < TELEMETRY_TYPE_COUNT ? typeNames[type] : "?";
+}
+
+Telemetry::~Telemetry() {
+    stop();
+}
+
+bool Telemetry::start(const std::string& logPath, std::uint64_t sessionSeed, std::uint64_t fileBytes, int fileCount) {
+    path = logPath;
+    seed = sessionSeed;
+    maxBytes = std::max<std::uint64_t>(fileBytes, TELEMETRY_HEADER_SIZE + 64 * sizeof(TelemetryRecord));
+    files = std::max(fileCount, 1);
+    startTime = Clock::now();
+    startUnixNanoseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+    std::ofstream probe(path, std::ios::binary | std::ios::app);
+    if (!probe) return false;
+    probe.close();
+
+    running = true;
+    flusher = std::thread(&Telemetry::run, this);
+    return true;
+}
+
+void Telemetry::stop() {
+    if (!flusher.joinable()) return;
+    running = false;
+    flusher.join();
+}
+
+void Telemetry::recordStep(const Simulation& sim) {
+    std::uint32_t tick = sim.clock.tick;
+
+    // A new game starts over from full lives and the first wave, whatever
+    // the last one ended on.
+    bool newGame = sim.gameState == PLAY_STATE
+        && (lastState == BEGINNING_STATE || lastState == DEFEAT_STATE || lastState == WINNER_STATE);
+    if (newGame) {
+        lastLives = START_LIVES;
+        lastWave = 1;
+    }
+
+    int kills = 0;
+    for (GameEvent event : sim.events) {
+        if (event == EVENT_ALIEN_DESTROYED) kills++;
+    }
+    if (kills > 0) record(TELEMETRY_SIMULATION, TELEMETRY_KILLS, tick, sim.wave, kills, sim.score);
+    if (sim.lives < lastLives) record(TELEMETRY_SIMULATION, TELEMETRY_LIFE_LOST, tick, sim.wave, sim.lives);
+
+    if (sim.gameState != lastState) {
+        // The wave counter has already moved on when the clear is seen.
+        if (lastState == PLAY_STATE && (sim.gameState == NEXT_WAVE_STATE || sim.gameState == WINNER_STATE)) {
+            record(TELEMETRY_SIMULATION, TELEMETRY_WAVE_CLEARED, tick, lastWave, static_cast<int>(tick - waveStartTick), sim.lives);
+        }
+        if (sim.gameState == PLAY_STATE && lastState != PAUSE_STATE) {
+            waveStartTick = tick;
+            record(TELEMETRY_SIMULATION, TELEMETRY_WAVE_STARTED, tick, sim.wave, sim.lives, sim.score);
+        }
+        record(TELEMETRY_SIMULATION, TELEMETRY_STATE_CHANGE, tick, sim.wave, lastState, sim.gameState);
+    }
+
+    lastState = sim.gameState;
+    lastLives = sim.lives;
+    lastWave = sim.wave;
+}
+
+void Telemetry::sync(const Simulation& sim) {
+    // The wave's start is unknown after a jump; restarting the count keeps
+    // the next clear's duration from going negative.
+    if (sim.wave != lastWave || sim.clock.tick < waveStartTick) waveStartTick = sim.clock.tick;
+    lastState = sim.gameState;
+    lastLives = sim.lives;
+    lastWave = sim.wave;
+}
+
+void Telemetry::recordFrame(float seconds, const Simulation& sim) {
+    record(TELEMETRY_FRAMES, TELEMETRY_FRAME, sim.clock.tick, sim.wave, static_cast<int>(seconds * 1000000.0f), sim.gameState);
+}
+
+bool readTelemetryHeader(std::istream& file, TelemetryHeader& header) {
+    char bytes[TELEMETRY_HEADER_SIZE];
+    if (!file.read(bytes, sizeof(bytes)) || std::memcmp(bytes, "INVT", 4) != 0) return false;
+    std::memcpy(&header.version, bytes + 4, 2);
+    std::memcpy(&header.recordSize, bytes + 6, 2);
+    std::memcpy(&header.startUnixNanoseconds, bytes + 8, 8);
+    std::memcpy(&header.seed, bytes + 16, 8);
+    return true;
+}
+
+struct TelemetryFile {
+    std::ofstream file;
+    std::uint64_t bytes = 0;
+};
+
+static void openLog(TelemetryFile& log, const Telemetry& telemetry) {
+    log.file.open(telemetry.path, std::ios::binary | std::ios::trunc);
+    char header[TELEMETRY_HEADER_SIZE] = { 'I', 'N', 'V', 'T' };
+    std::uint16_t version = TELEMETRY_VERSION;
+    std::uint16_t recordSize = sizeof(TelemetryRecord);
+    std::memcpy(header + 4, &version, 2);
+    std::memcpy(header + 6, &recordSize, 2);
+    std::memcpy(header + 8, &telemetry.startUnixNanoseconds, 8);
+    std::memcpy(header + 16, &telemetry.seed, 8);
+    log.file.write(header, sizeof(header));
+    log.bytes = sizeof(header);
+}
+
+// path.(files-1) is deleted, every older log moves up one, and path starts over.
+static void rotateLog(TelemetryFile& log, const Telemetry& telemetry) {
+    log.file.close();
+    for (int i = telemetry.files - 1; i >= 1; i--) {
+        std::string to = telemetry.path + "." + std::to_string(i);
+        std::string from = i == 1 ? telemetry.path : telemetry.path + "." + std::to_string(i - 1);
+        std::remove(to.c_str());
+        std::rename(from.c_str(), to.c_str());
+    }
+    openLog(log, telemetry);
+}
+
+void Telemetry::run() {
+    TelemetryFile log;
+    openLog(log, *this);
+    std::uint32_t reportedDrops[TELEMETRY_CHANNEL_COUNT] = {};
+
+    for (;;) {
+        // Checked before draining, so the last pass sees everything pushed
+        // before stop().
+        bool stopping = !running;
+
+        for (int channel = 0; channel < TELEMETRY_CHANNEL_COUNT; channel++) {
+            TelemetryRing& ring = channels[channel];
+            std::uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+            std::uint32_t head = ring.head.load(std::memory_order_acquire);
+            while (tail != head) {
+                // Write the contiguous run up to the end of the ring in one go.
+                std::uint32_t index = tail & (TELEMETRY_RING_SIZE - 1);
+                std::uint32_t count = std::min(head - tail, static_cast<std::uint32_t>(TELEMETRY_RING_SIZE) - index);
+                if (log.bytes + sizeof(TelemetryRecord) > maxBytes) rotateLog(log, *this);
+                count = static_cast<std::uint32_t>(std::min<std::uint64_t>(count, (maxBytes - log.bytes) / sizeof(TelemetryRecord)));
+                std::uint64_t size = static_cast<std::uint64_t>(count) * sizeof(TelemetryRecord);
+                log.file.write(reinterpret_cast<const char*>(&ring.records[index]), size);
+                log.bytes += size;
+                tail += count;
+                ring.tail.store(tail, std::memory_order_release);
+            }
+
+            std::uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+            if (dropped != reportedDrops[channel]) {
+                TelemetryRecord lost = {};
+                lost.time = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count());
+                lost.type = TELEMETRY_DROPPED;
+                lost.value0 = static_cast<std::int32_t>(dropped - reportedDrops[channel]);
+                lost.value1 = channel;
+                if (log.bytes + sizeof(lost) > maxBytes) rotateLog(log, *this);
+                log.file.write(reinterpret_cast<const char*>(&lost), sizeof(lost));
+                log.bytes += sizeof(lost);
+                reportedDrops[channel] = dropped;
+            }
+        }
+        log.file.flush();
+
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_FLUSH_MS));
+    }
+}
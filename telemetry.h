@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation.h"
+
+// Telemetry log layout (host byte order, little endian on every target):
+//   header  "INVT" u16 version u16 recordSize u64 startUnixNanoseconds u64 seed
+//   body    TelemetryRecord, one after another
+// A full log is renamed to path.1 (path.1 to path.2 and so on) and a fresh
+// one started, so a session never uses more than files x maxBytes of disk.
+// tools/teldecode.cpp turns logs into CSV.
+
+const std::uint16_t TELEMETRY_VERSION = 1;
+const int TELEMETRY_HEADER_SIZE = 24;
+const int TELEMETRY_RING_SIZE = 1 << 14;
+const int TELEMETRY_FLUSH_MS = 100;
+
+enum TelemetryType {
+    // value0: previous GameState, value1: new GameState
+    TELEMETRY_STATE_CHANGE,
+    // value0: lives left, value1: score
+    TELEMETRY_WAVE_STARTED,
+    // value0: ticks played in the wave, value1: lives left
+    TELEMETRY_WAVE_CLEARED,
+    // value0: aliens killed this tick, value1: score
+    TELEMETRY_KILLS,
+    // value0: lives left
+    TELEMETRY_LIFE_LOST,
+    // value0: frame time in microseconds, value1: GameState
+    TELEMETRY_FRAME,
+    // value0: records lost because a ring was full, value1: channel
+    TELEMETRY_DROPPED,
+    TELEMETRY_TYPE_COUNT
+};
+
+const char* telemetryTypeName(int type);
+
+struct TelemetryHeader {
+    std::uint16_t version = 0;
+    std::uint16_t recordSize = 0;
+    std::uint64_t startUnixNanoseconds = 0;
+    std::uint64_t seed = 0;
+};
+
+// Reads the header of a log opened in binary mode, leaving file at the first
+// record; false if it is not a telemetry log. The version is the caller's to
+// check.
+bool readTelemetryHeader(std::istream& file, TelemetryHeader& header);
+
+struct TelemetryRecord {
+    // Nanoseconds since the session started.
+    std::uint64_t time;
+    std::uint32_t tick;
+    std::uint16_t type;
+    std::uint16_t wave;
+    std::int32_t value0;
+    std::int32_t value1;
+};
+
+static_assert(sizeof(TelemetryRecord) == 24, "records are written as raw bytes");
+
+// Single-producer, single-consumer ring. push() is a handful of plain stores
+// and one release store; when the consumer falls behind it drops the record
+// and counts it rather than wait.
+struct TelemetryRing {
+    std::vector<TelemetryRecord> records;
+    alignas(64) std::atomic<std::uint32_t> head{ 0 };
+    std::uint32_t cachedTail = 0;
+    std::atomic<std::uint32_t> dropped{ 0 };
+    alignas(64) std::atomic<std::uint32_t> tail{ 0 };
+
+    TelemetryRing() : records(TELEMETRY_RING_SIZE) {}
+
+    bool push(const TelemetryRecord& record) {
+        std::uint32_t position = head.load(std::memory_order_relaxed);
+        if (position - cachedTail == TELEMETRY_RING_SIZE) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position - cachedTail == TELEMETRY_RING_SIZE) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        records[position & (TELEMETRY_RING_SIZE - 1)] = record;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// One ring per producing thread: the thread that steps the simulation and
+// the thread that presents frames. They are the same thread unless the game
+// runs --threaded.
+enum TelemetryChannel {
+    TELEMETRY_SIMULATION,
+    TELEMETRY_FRAMES,
+    TELEMETRY_CHANNEL_COUNT
+};
+
+struct Telemetry {
+    typedef std::chrono::steady_clock Clock;
+
+    TelemetryRing channels[TELEMETRY_CHANNEL_COUNT];
+    Clock::time_point startTime;
+    // The same moment on the wall clock; every rotated log repeats it.
+    std::uint64_t startUnixNanoseconds = 0;
+    std::string path;
+    std::uint64_t maxBytes = 0;
+    int files = 0;
+    std::uint64_t seed = 0;
+    std::atomic<bool> running{ false };
+    std::thread flusher;
+
+    // What recordStep() saw last; only the stepping thread touches these.
+    GameState lastState = BEGINNING_STATE;
+    int lastLives = START_LIVES;
+    int lastWave = 1;
+    std::uint32_t waveStartTick = 0;
+
+    Telemetry() = default;
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+    ~Telemetry();
+
+    bool start(const std::string& logPath, std::uint64_t sessionSeed, std::uint64_t fileBytes = 8 * 1024 * 1024, int fileCount = 4);
+    // Flushes everything still queued and closes the log.
+    void stop();
+
+    void record(TelemetryChannel channel, TelemetryType type, std::uint32_t tick, int wave, int value0, int value1 = 0) {
+        TelemetryRecord entry;
+        entry.time = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count());
+        entry.tick = tick;
+        entry.type = static_cast<std::uint16_t>(type);
+        entry.wave = static_cast<std::uint16_t>(wave);
+        entry.value0 = value0;
+        entry.value1 = value1;
+        channels[channel].push(entry);
+    }
+
+    // Call after every step; turns what changed into events.
+    void recordStep(const Simulation& sim);
+    // Call when sim jumps rather than steps (the first state, a quickload or
+    // a rewind) so the jump is not taken for lost lives or a state change.
+    void sync(const Simulation& sim);
+    void recordFrame(float seconds, const Simulation& sim);
+
+private:
+    void run();
+};
@@ -0,0 +1,142 @@
+// Checks for AssetPack: a well-formed pack opens and finds its entries, and
+// truncated or corrupt packs are refused before anything reads the index.
+//
+//   g++ -std=c++17 -O2 -I.. assetpack.cpp ../assetpack.cpp ../simulation.cpp
+//       ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp
+//       ../savestate.cpp
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "assetpack.h"
+#include "check.h"
+
+static void putU32(std::vector<std::uint8_t>& bytes, std::size_t at, std::uint32_t value) {
+    for (int i = 0; i < 4; i++) bytes[at + i] = static_cast<std::uint8_t>(value >> (i * 8));
+}
+
+static void putU64(std::vector<std::uint8_t>& bytes, std::size_t at, std::uint64_t value) {
+    for (int i = 0; i < 8; i++) bytes[at + i] = static_cast<std::uint8_t>(value >> (i * 8));
+}
+
+static std::size_t entryAt(int index) {
+    return ASSET_PACK_HEADER_SIZE + index * ASSET_PACK_ENTRY_SIZE;
+}
+
+// A pack laid out the way tools/packer.cpp writes one.
+static std::vector<std::uint8_t> buildPack(const std::vector<std::string>& names, const std::vector<std::string>& contents) {
+    std::size_t offset = entryAt(static_cast<int>(names.size()));
+    std::vector<std::uint8_t> bytes(offset, 0);
+    std::memcpy(bytes.data(), "INVA", 4);
+    putU32(bytes, 4, ASSET_PACK_VERSION);
+    putU32(bytes, 8, static_cast<std::uint32_t>(names.size()));
+    for (std::size_t i = 0; i < names.size(); i++) {
+        offset = (bytes.size() + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+        bytes.resize(offset, 0);
+        bytes.insert(bytes.end(), contents[i].begin(), contents[i].end());
+        std::size_t entry = entryAt(static_cast<int>(i));
+        std::memcpy(&bytes[entry], names[i].c_str(), names[i].size());
+        putU64(bytes, entry + ASSET_NAME_LENGTH, offset);
+        putU64(bytes, entry + ASSET_NAME_LENGTH + 8, contents[i].size());
+    }
+    return bytes;
+}
+
+static bool opens(const std::vector<std::uint8_t>& bytes) {
+    const char* path = "tests_pack.pak";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    AssetPack pack;
+    bool opened = pack.open(path);
+    std::remove(path);
+    return opened;
+}
+
+static void testValidPack() {
+    std::vector<std::uint8_t> bytes = buildPack({ "ship.png", "pew2.wav" }, { "shipdata", "a longer sound payload" });
+    const char* path = "tests_pack.pak";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    AssetPack pack;
+    CHECK(pack.open(path));
+    CHECK(pack.entryCount == 2);
+    CHECK(pack.entryName(1) == "pew2.wav");
+    CHECK(pack.entrySize(0) == 8);
+
+    const void* data = nullptr;
+    std::size_t length = 0;
+    CHECK(pack.find("pew2.wav", data, length));
+    CHECK(length == 22 && std::memcmp(data, "a longer sound payload", 22) == 0);
+    CHECK(!pack.find("missing.png", data, length));
+    pack.close();
+    CHECK(!pack.isOpen());
+    std::remove(path);
+
+    CHECK(!pack.open("tests_no_such_pack.pak"));
+    CHECK(opens(buildPack({}, {})));
+}
+
+static void testCorruptPacks() {
+    const std::vector<std::uint8_t> good = buildPack({ "ship.png", "pew2.wav" }, { "shipdata", "a longer sound payload" });
+    CHECK(opens(good));
+
+    // Cut off inside the header, inside the index, and inside the last file.
+    const std::size_t cuts[] = { 0, 3, ASSET_PACK_HEADER_SIZE - 1, entryAt(1) + 10, good.size() - 1 };
+    for (std::size_t cut : cuts) {
+        CHECK(!opens(std::vector<std::uint8_t>(good.begin(), good.begin() + cut)));
+    }
+
+    std::vector<std::uint8_t> bad = good;
+    bad[0] = 'X';
+    CHECK(!opens(bad));
+
+    bad = good;
+    putU32(bad, 4, ASSET_PACK_VERSION + 1);
+    CHECK(!opens(bad));
+
+    // An entry count the file cannot hold, including one that would overflow
+    // a 32-bit index size.
+    bad = good;
+    putU32(bad, 8, 3);
+    CHECK(!opens(bad));
+    bad = good;
+    putU32(bad, 8, 0xffffffffu);
+    CHECK(!opens(bad));
+
+    // Offsets and sizes that point past the end, or wrap around it.
+    bad = good;
+    putU64(bad, entryAt(0) + ASSET_NAME_LENGTH, good.size() + 1);
+    CHECK(!opens(bad));
+    bad = good;
+    putU64(bad, entryAt(1) + ASSET_NAME_LENGTH + 8, 23);
+    CHECK(!opens(bad));
+    bad = good;
+    putU64(bad, entryAt(1) + ASSET_NAME_LENGTH + 8, ~std::uint64_t(0));
+    CHECK(!opens(bad));
+
+    // A name with no terminator would run into the offset field.
+    bad = good;
+    std::memset(&bad[entryAt(0)], 'a', ASSET_NAME_LENGTH);
+    CHECK(!opens(bad));
+}
+
+// The system's answer wins over a bare argv[0] with no directory in it.
+static void testExecutableDirectory() {
+    std::string directory = executableDirectory("assetpack");
+#if defined(_WIN32) || defined(__linux__)
+    CHECK(!directory.empty());
+#endif
+    CHECK(directory.empty() || directory.back() == '/' || directory.back() == '\\');
+}
+
+int main() {
+    testValidPack();
+    testCorruptPacks();
+    testExecutableDirectory();
+    return finish("assetpack");
+}
@@ -0,0 +1,60 @@
+// Checks for bunker erosion: a column of shots pierces a bunker from either
+// side, and in play a bolt digs through one.
+//
+//   g++ -std=c++17 -O2 -I.. bunker.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include <algorithm>
+#include "bunker.h"
+#include "check.h"
+#include "simulation.h"
+
+static void testBunker() {
+    // Shots down one column pierce the bunker from either side, wherever the
+    // column falls.
+    int most = 0;
+    for (int downward = 0; downward < 2; downward++) {
+        for (float offset = -20.0f; offset <= 20.0f; offset += 0.25f) {
+            Bunker bunker;
+            bunker.reset(100.0f, 200.0f);
+            float center = 100.0f + BUNKER_WIDTH / 2 + offset;
+            int shots = 0;
+            int row;
+            while (shots < 32 && (row = bunker.firstSolidRow(center, 200.0f, BUNKER_HEIGHT, downward != 0)) >= 0) {
+                bunker.erode(center, row, downward != 0);
+                shots++;
+            }
+            CHECK(shots < 32);
+            most = std::max(most, shots);
+        }
+    }
+    CHECK(most > 1);
+
+    // In play: a ship parked under a bunker gets a bolt through it.
+    Simulation sim(3);
+    InputFrame start;
+    start.start = true;
+    sim.step(start, TICK_SECONDS);
+    const Bunker& bunker = sim.bunkers[1];
+    bool through = false;
+    int hits = 0;
+    for (int tick = 0; tick < 60 * TICKS_PER_SECOND && !through && sim.gameState == PLAY_STATE; tick++) {
+        sim.ship.x = bunker.x + BUNKER_WIDTH / 2 - SHIP_SIZE / 2;
+        InputFrame input;
+        input.fire = true;
+        input.firePressed = true;
+        sim.step(input, TICK_SECONDS);
+        for (GameEvent event : sim.events) {
+            if (event == EVENT_BUNKER_HIT) hits++;
+        }
+        sim.playerBolts.forEach([&](int, const Bolt& bolt) {
+            if (bolt.y + BOLT_HEIGHT < bunker.y) through = true;
+        });
+    }
+    CHECK(hits > 0);
+    CHECK(through);
+}
+
+int main() {
+    testBunker();
+    return finish("bunker");
+}
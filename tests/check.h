@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdio>
+
+// The harness every headless check program shares. CHECK counts each
+// condition and prints the ones that fail; main returns finish(), which exits
+// non-zero if there was one. Programs write their scratch files to the working
+// directory and remove them. tests/run.sh builds and runs them all, then the
+// benchmark's --strict allocation check.
+inline int checks = 0;
+inline int failures = 0;
+
+inline void check(bool passed, const char* condition, const char* file, int line) {
+    checks++;
+    if (passed) return;
+    failures++;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+inline int finish(const char* name) {
+    std::printf("%s: %d checks, %d failed\n", name, checks, failures);
+    return failures > 0 ? 1 : 0;
+}
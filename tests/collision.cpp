@@ -0,0 +1,179 @@
+// Checks for the collision queries: the uniform-grid broadphase and the
+// formation grid lookup, each against a brute-force scan, and the pixel-mask
+// narrow phase against a per-pixel test.
+//
+//   g++ -std=c++17 -O2 -I.. collision.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include <vector>
+#include "check.h"
+#include "collision.h"
+#include "formation.h"
+#include "rng.h"
+
+static float randomFloat(Rng& rng, float low, float high) {
+    return low + (high - low) * (rng.next() / 4294967296.0f);
+}
+
+static Rect randomRect(Rng& rng, float width, float height, float largest) {
+    Rect rect;
+    rect.left = randomFloat(rng, -largest, width);
+    rect.top = randomFloat(rng, -largest, height);
+    rect.width = randomFloat(rng, 1.0f, largest);
+    rect.height = randomFloat(rng, 1.0f, largest);
+    return rect;
+}
+
+static void testUniformGrid() {
+    Rng rng(11);
+    UniformGrid grid;
+    grid.reset(800.0f, 600.0f, 64.0f);
+    grid.reserve(300);
+
+    for (int round = 0; round < 20; round++) {
+        // Some items reach past the world and some span several cells.
+        std::vector<Rect> items(50 + round * 10);
+        for (Rect& item : items) item = randomRect(rng, 800.0f, 600.0f, round % 2 ? 40.0f : 150.0f);
+        grid.build(static_cast<int>(items.size()), [&](int i) { return items[i]; });
+
+        bool exact = true;
+        for (int query = 0; query < 50; query++) {
+            Rect rect = randomRect(rng, 800.0f, 600.0f, 100.0f);
+            std::vector<int> seen(items.size(), 0);
+            grid.query(rect, [&](int id) {
+                seen[id]++;
+                return false;
+            });
+            for (std::size_t i = 0; i < items.size(); i++) {
+                exact = exact && seen[i] == (intersects(rect, items[i]) ? 1 : 0);
+            }
+        }
+        CHECK(exact);
+    }
+
+    // The visitor ends the query by returning true.
+    std::vector<Rect> stacked(10, Rect{ 100.0f, 100.0f, 20.0f, 20.0f });
+    grid.build(10, [&](int i) { return stacked[i]; });
+    int visits = 0;
+    CHECK(grid.query(Rect{ 90.0f, 90.0f, 40.0f, 40.0f }, [&](int) { return ++visits == 3; }));
+    CHECK(visits == 3);
+    CHECK(!grid.query(Rect{ 500.0f, 500.0f, 10.0f, 10.0f }, [&](int) { return true; }));
+
+    grid.build(0, [&](int i) { return stacked[i]; });
+    CHECK(!grid.query(Rect{ 90.0f, 90.0f, 40.0f, 40.0f }, [&](int) { return true; }));
+}
+
+// What queryFormation must return: the living alien the rectangle touches in
+// the lowest row, leftmost first.
+static int bruteFormation(const Formation& formation, const Rect& rect, float alienSize) {
+    for (int row = formation.rows - 1; row >= 0; row--) {
+        for (int column = 0; column < formation.columns; column++) {
+            int slot = formation.slot(row, column);
+            Rect alien = { formation.x[slot], formation.y[slot], alienSize, alienSize };
+            if (formation.isAlive(slot) && intersects(rect, alien)) return slot;
+        }
+    }
+    return -1;
+}
+
+static void testQueryFormation() {
+    const float size = 36.0f;
+    Rng rng(5);
+    Formation formation;
+    formation.reset(5, 11, 40.0f, 80.0f, 60.0f, 0);
+
+    bool exact = true;
+    for (int round = 0; round < 40; round++) {
+        for (int query = 0; query < 200; query++) {
+            Rect rect = randomRect(rng, 800.0f, 500.0f, round % 2 ? 10.0f : 90.0f);
+            exact = exact && queryFormation(formation, rect, size) == bruteFormation(formation, rect, size);
+        }
+        // Thin the formation out, edges included, and move it.
+        for (int kill = 0; kill < 2 && formation.livingCount > 0; kill++) {
+            int slot = static_cast<int>(rng.below(formation.size()));
+            if (formation.isAlive(slot)) formation.kill(slot, round);
+        }
+        formation.translate(randomFloat(rng, -5.0f, 5.0f), 2.0f);
+    }
+    CHECK(exact);
+
+    // A bolt between two aliens hits neither.
+    formation.reset(1, 2, 0.0f, 0.0f, 60.0f, 0);
+    CHECK(queryFormation(formation, Rect{ 40.0f, 0.0f, 8.0f, 30.0f }, size) == -1);
+    CHECK(queryFormation(formation, Rect{ 30.0f, 0.0f, 8.0f, 30.0f }, size) == 0);
+    CHECK(queryFormation(formation, Rect{ 55.0f, 0.0f, 8.0f, 30.0f }, size) == 1);
+}
+
+// A ring: solid at distance 4 to 7 from the centre of a 16x16 frame, hollow
+// inside and transparent in the corners.
+static std::vector<std::uint8_t> ringImage(int imageWidth, int left, int top) {
+    std::vector<std::uint8_t> rgba(imageWidth * (top + 16) * 4, 255);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            int dx = 2 * x - 15;
+            int dy = 2 * y - 15;
+            int distance = dx * dx + dy * dy;
+            bool solid = distance >= 64 && distance < 225;
+            rgba[((top + y) * imageWidth + left + x) * 4 + 3] = solid ? 200 : 20;
+        }
+    }
+    return rgba;
+}
+
+static bool solidPixel(const CollisionMask& mask, int x, int y) {
+    return x >= 0 && y >= 0 && x < mask.width && y < mask.height && ((mask.rows[y] >> x) & 1);
+}
+
+static void testMasks() {
+    // The frame sits inside a larger, fully opaque sheet.
+    std::vector<std::uint8_t> sheet = ringImage(40, 10, 5);
+    CollisionMask mask = maskFromPixels(sheet.data(), 40, 10, 5, 16, 16);
+    CHECK(mask.width == 16 && mask.height == 16);
+    CHECK(!solidPixel(mask, 0, 0));
+    CHECK(!solidPixel(mask, 7, 7));
+    CHECK(solidPixel(mask, 7, 1));
+    CHECK(solidPixel(mask, 1, 7));
+    CHECK(maskFromPixels(sheet.data(), 40, 10, 5, 16, 16, 250).rows == std::vector<std::uint64_t>(16, 0));
+
+    // Any rectangle overlaps the mask exactly when it covers a solid pixel,
+    // with the mask at a fractional position.
+    Rng rng(8);
+    bool exact = true;
+    for (int i = 0; i < 5000; i++) {
+        float x = randomFloat(rng, 0.0f, 1.0f);
+        float y = randomFloat(rng, 0.0f, 1.0f);
+        Rect rect = { randomFloat(rng, -6.0f, 20.0f), randomFloat(rng, -6.0f, 20.0f), randomFloat(rng, 0.5f, 6.0f), randomFloat(rng, 0.5f, 6.0f) };
+        bool covered = false;
+        for (int py = 0; py < 16; py++) {
+            for (int px = 0; px < 16; px++) {
+                Rect pixel = { x + px, y + py, 1.0f, 1.0f };
+                covered = covered || (solidPixel(mask, px, py) && intersects(rect, pixel));
+            }
+        }
+        exact = exact && maskOverlapsRect(mask, x, y, rect) == covered;
+    }
+    CHECK(exact);
+
+    // A 64-pixel-wide frame uses every bit of a row.
+    CollisionMask wide;
+    wide.width = 64;
+    wide.height = 1;
+    wide.rows.assign(1, std::uint64_t(1) << 63);
+    CHECK(maskOverlapsRect(wide, 0.0f, 0.0f, Rect{ -10.0f, 0.0f, 80.0f, 1.0f }));
+    CHECK(maskOverlapsRect(wide, 0.0f, 0.0f, Rect{ 63.0f, 0.0f, 1.0f, 1.0f }));
+    CHECK(!maskOverlapsRect(wide, 0.0f, 0.0f, Rect{ 0.0f, 0.0f, 63.0f, 1.0f }));
+
+    // In the formation a bolt through the hollow centre misses; one through
+    // the ring hits.
+    Formation formation;
+    formation.reset(1, 1, 100.0f, 100.0f, 60.0f, 0);
+    CHECK(queryFormation(formation, Rect{ 106.0f, 106.0f, 4.0f, 4.0f }, 16.0f) == 0);
+    CHECK(queryFormation(formation, Rect{ 106.0f, 106.0f, 4.0f, 4.0f }, 16.0f, &mask) == -1);
+    CHECK(queryFormation(formation, Rect{ 106.0f, 100.0f, 4.0f, 2.0f }, 16.0f, &mask) == 0);
+}
+
+int main() {
+    testUniformGrid();
+    testQueryFormation();
+    testMasks();
+    return finish("collision");
+}
@@ -0,0 +1,66 @@
+// Checks for the formation's incremental shooter index against one rebuilt
+// from the alive bits.
+//
+//   g++ -std=c++17 -O2 -I.. formation.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include <algorithm>
+#include "check.h"
+#include "formation.h"
+
+// The incremental shooter index must agree with one rebuilt from scratch.
+static bool shootersConsistent(const Formation& formation) {
+    Formation rebuilt = formation;
+    rebuilt.recount();
+    if (rebuilt.livingCount != formation.livingCount || rebuilt.lowestRow != formation.lowestRow) return false;
+    if (formation.shooterCount() != formation.columns - static_cast<int>(std::count(formation.lowestRow.begin(), formation.lowestRow.end(), -1))) return false;
+    for (int i = 0; i < formation.shooterCount(); i++) {
+        int column = formation.shooterColumns[i];
+        if (formation.shooterPosition[column] != i) return false;
+        if (!formation.isAlive(formation.shooterSlot(i))) return false;
+    }
+    return true;
+}
+
+static void testFormation() {
+    Formation formation;
+    formation.reset(3, 10, 0.0f, 0.0f, 60.0f, 0);
+    CHECK(formation.livingCount == 30);
+    CHECK(formation.shooterCount() == 10);
+    CHECK(shootersConsistent(formation));
+
+    // The bottom alien goes first and the one above takes over shooting.
+    formation.kill(formation.slot(2, 4), 1);
+    CHECK(formation.lowestRow[4] == 1);
+    CHECK(formation.shooterSlot(formation.shooterPosition[4]) == formation.slot(1, 4));
+    CHECK(formation.isDying(formation.slot(2, 4)));
+    CHECK(shootersConsistent(formation));
+
+    // A column with a gap keeps its lowest survivor.
+    formation.kill(formation.slot(1, 4), 2);
+    formation.kill(formation.slot(2, 7), 2);
+    formation.kill(formation.slot(0, 7), 2);
+    CHECK(formation.lowestRow[7] == 1);
+    CHECK(shootersConsistent(formation));
+
+    formation.kill(formation.slot(0, 4), 3);
+    CHECK(formation.lowestRow[4] == -1);
+    CHECK(formation.shooterPosition[4] == -1);
+    CHECK(formation.shooterCount() == 9);
+    CHECK(shootersConsistent(formation));
+
+    for (int slot = 0; slot < formation.size(); slot++) {
+        if (formation.isAlive(slot)) formation.kill(slot, 4);
+    }
+    CHECK(formation.livingCount == 0);
+    CHECK(formation.shooterCount() == 0);
+    CHECK(!formation.empty());
+    for (int slot = 0; slot < formation.size(); slot++) {
+        if (formation.isDying(slot)) formation.remove(slot);
+    }
+    CHECK(formation.empty());
+}
+
+int main() {
+    testFormation();
+    return finish("formation");
+}
@@ -0,0 +1,41 @@
+// Checks for the HUD's allocation-free number formatting against printf.
+//
+//   g++ -std=c++17 -O2 -I.. hud.cpp ../hud.cpp ../batch.cpp ../simulation.cpp
+//       ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp
+//       ../savestate.cpp -lsfml-graphics -lsfml-window -lsfml-system
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include "check.h"
+#include "hud.h"
+#include "rng.h"
+
+static bool formatsLikePrintf(int value) {
+    char digits[HUD_NUMBER_LENGTH];
+    char expected[32];
+    std::snprintf(expected, sizeof(expected), "%d", value);
+    return std::strcmp(formatNumber(value, digits), expected) == 0;
+}
+
+static void testFormatNumber() {
+    const int values[] = { 0, 1, 9, 10, 99, 100, 12345, -1, -10, -987654, INT_MAX, INT_MIN, INT_MIN + 1 };
+    for (int value : values) CHECK(formatsLikePrintf(value));
+
+    Rng rng(4);
+    bool same = true;
+    for (int i = 0; i < 100000; i++) {
+        same = same && formatsLikePrintf(static_cast<int>(rng.next() >> rng.below(32)));
+        same = same && formatsLikePrintf(-static_cast<int>(rng.next() >> (1 + rng.below(31))));
+    }
+    CHECK(same);
+
+    // The text ends at the end of the buffer, however short it is.
+    char digits[HUD_NUMBER_LENGTH];
+    CHECK(formatNumber(7, digits) == digits + HUD_NUMBER_LENGTH - 2);
+    CHECK(formatNumber(INT_MIN, digits) == digits);
+}
+
+int main() {
+    testFormatNumber();
+    return finish("hud");
+}
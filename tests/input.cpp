@@ -0,0 +1,158 @@
+// Checks for the input layer: key binding strings, held keys and latched
+// presses built from events, what the threaded simulation is handed, and
+// that only presses fire.
+//
+//   g++ -std=c++17 -O2 -I.. input.cpp ../input.cpp ../simthread.cpp ../sfmlaudio.cpp
+//       ../mixer.cpp ../telemetry.cpp ../resources.cpp ../assetpack.cpp ../simulation.cpp
+//       ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp
+//       ../savestate.cpp -pthread
+//       -lsfml-graphics -lsfml-window -lsfml-audio -lsfml-system
+#include "check.h"
+#include "input.h"
+#include "replay.h"
+#include "simthread.h"
+
+static sf::Event keyEvent(sf::Event::EventType type, sf::Keyboard::Key code) {
+    sf::Event event;
+    event.type = type;
+    event.key.code = code;
+    event.key.alt = event.key.control = event.key.shift = event.key.system = false;
+    return event;
+}
+
+static void testBindings() {
+    KeyBindings bindings;
+    CHECK(bindings.keys[ACTION_FIRE][0] == sf::Keyboard::Space);
+    CHECK(bindings.keys[ACTION_FIRE][1] == sf::Keyboard::Unknown);
+
+    CHECK(bindings.bind("left=A,Left"));
+    CHECK(bindings.keys[ACTION_MOVE_LEFT][0] == sf::Keyboard::A);
+    CHECK(bindings.keys[ACTION_MOVE_LEFT][1] == sf::Keyboard::Left);
+    CHECK(bindings.bind("left=J"));
+    CHECK(bindings.keys[ACTION_MOVE_LEFT][0] == sf::Keyboard::J);
+    CHECK(bindings.keys[ACTION_MOVE_LEFT][1] == sf::Keyboard::Unknown);
+
+    // A rejected binding leaves the action as it was.
+    const char* rejected[] = { "left", "jump=Space", "left=", "left=J,", "left=Nope", "left=a", "left=A,B,C", "=A" };
+    for (const char* binding : rejected) CHECK(!bindings.bind(binding));
+    CHECK(bindings.keys[ACTION_MOVE_LEFT][0] == sf::Keyboard::J);
+}
+
+static void testInputState() {
+    InputState input;
+    InputState::Clock::time_point start = InputState::Clock::now();
+    InputState::Clock::time_point since;
+    CHECK(!input.takeChange(since));
+
+    // 'S' is bound to both start and down: one press drives both.
+    CHECK(input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::S), start));
+    CHECK(!input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::F12), start));
+    InputFrame frame = input.take();
+    CHECK(frame.start && frame.moveDown);
+    CHECK(input.takeChange(since) && since == start);
+    CHECK(!input.takeChange(since));
+
+    // Held keys stay in every take; the edge only in the first.
+    frame = input.take();
+    CHECK(!frame.start && frame.moveDown);
+
+    // Key repeat is not another press.
+    input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::Space), start);
+    CHECK(input.take().firePressed);
+    input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::Space), start);
+    frame = input.take();
+    CHECK(frame.fire && !frame.firePressed);
+
+    // A tap released before the tick still fires once.
+    input.handle(keyEvent(sf::Event::KeyReleased, sf::Keyboard::Space), start);
+    input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::Space), start);
+    input.handle(keyEvent(sf::Event::KeyReleased, sf::Keyboard::Space), start);
+    frame = input.take();
+    CHECK(frame.fire && frame.firePressed);
+    frame = input.take();
+    CHECK(!frame.fire && !frame.firePressed);
+
+    // Losing focus lets go of everything.
+    sf::Event lost;
+    lost.type = sf::Event::LostFocus;
+    CHECK(!input.handle(lost, start));
+    CHECK(!input.take().moveDown);
+
+    // The two halves of take(): presses once, held keys every time.
+    input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::A), start);
+    InputFrame presses = input.takePresses();
+    CHECK(presses.moveLeft && !presses.firePressed);
+    CHECK(!input.takePresses().moveLeft);
+    CHECK(input.heldFrame().moveLeft);
+    CHECK(!input.heldFrame().start);
+}
+
+// The simulation thread is handed held keys that it replaces every frame and
+// presses that it keeps until a tick; releasing a held key must not leave it
+// in the presses.
+static void testSubmit() {
+    Simulation sim(1);
+    NullAudioBackend audio;
+    Mixer mixer(audio);
+    SimulationThread thread(sim, mixer, nullptr, nullptr);
+
+    InputState input;
+    InputState::Clock::time_point now = InputState::Clock::now();
+    input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::A), now);
+    InputFrame presses = input.takePresses();
+    thread.submit(input.heldFrame(), presses);
+    presses = input.takePresses();
+    thread.submit(input.heldFrame(), presses);
+    input.handle(keyEvent(sf::Event::KeyReleased, sf::Keyboard::A), now);
+    input.handle(keyEvent(sf::Event::KeyPressed, sf::Keyboard::Space), now);
+    input.handle(keyEvent(sf::Event::KeyReleased, sf::Keyboard::Space), now);
+    presses = input.takePresses();
+    thread.submit(input.heldFrame(), presses);
+
+    InputFrame held = unpackInput(thread.heldKeys.load());
+    InputFrame pressed = unpackInput(thread.pressedKeys.load());
+    CHECK(!held.moveLeft && !held.fire);
+    CHECK(pressed.moveLeft);
+    CHECK(pressed.fire && pressed.firePressed);
+    CHECK(!pressed.moveRight && !pressed.start);
+}
+
+// Holding fire shoots once; each further shot takes another press.
+static void testFireOnPress() {
+    Simulation sim(2);
+    InputFrame start;
+    start.start = true;
+    sim.step(start, TICK_SECONDS);
+
+    int shots = 0;
+    for (int tick = 0; tick < 5 * TICKS_PER_SECOND; tick++) {
+        InputFrame input;
+        input.fire = true;
+        input.firePressed = tick == 0;
+        sim.step(input, TICK_SECONDS);
+        for (GameEvent event : sim.events) {
+            if (event == EVENT_SHIP_FIRED) shots++;
+        }
+    }
+    CHECK(shots == 1);
+
+    // A press during the cooldown is held back, not lost.
+    shots = 0;
+    for (int tick = 0; tick < 5 * TICKS_PER_SECOND; tick++) {
+        InputFrame input;
+        input.firePressed = tick == 0 || tick == 1;
+        sim.step(input, TICK_SECONDS);
+        for (GameEvent event : sim.events) {
+            if (event == EVENT_SHIP_FIRED) shots++;
+        }
+    }
+    CHECK(shots == 2);
+}
+
+int main() {
+    testBindings();
+    testInputState();
+    testSubmit();
+    testFireOnPress();
+    return finish("input");
+}
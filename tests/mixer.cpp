@@ -0,0 +1,118 @@
+// Checks for the mixer's voice allocation: per-effect polyphony, stealing by
+// priority and age, retiring finished voices, and dropped requests.
+//
+//   g++ -std=c++17 -O2 -I.. mixer.cpp ../mixer.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include "check.h"
+#include "mixer.h"
+
+static EffectConfig effect(float duration, int maxVoices, int priority) {
+    EffectConfig config;
+    config.duration = duration;
+    config.maxVoices = maxVoices;
+    config.priority = priority;
+    return config;
+}
+
+static void testPolyphony() {
+    NullAudioBackend audio;
+    Mixer mixer(audio);
+    mixer.setEffect(0, effect(1.0f, 2, 1));
+
+    // A third copy replaces the oldest of the two already playing.
+    mixer.post(0);
+    mixer.update(0.1f);
+    mixer.post(0);
+    mixer.update(0.1f);
+    int oldest = -1;
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        if (mixer.voices[i].effect == 0 && (oldest < 0 || mixer.voices[i].start < mixer.voices[oldest].start)) oldest = i;
+    }
+    mixer.post(0);
+    mixer.update(0.1f);
+    CHECK(mixer.activeVoices() == 2);
+    CHECK(mixer.stats.played == 3);
+    CHECK(mixer.stats.stolen == 1);
+    CHECK(audio.plays == 3 && audio.stops == 1);
+    CHECK(mixer.voices[oldest].start > 0.25);
+
+    // Voices retire once their effect has played out.
+    mixer.update(0.95f);
+    CHECK(mixer.activeVoices() == 1);
+    mixer.update(0.1f);
+    CHECK(mixer.activeVoices() == 0);
+    CHECK(audio.stops == 1);
+}
+
+static void testStealing() {
+    NullAudioBackend audio;
+    Mixer mixer(audio);
+    mixer.setEffect(0, effect(10.0f, MIXER_VOICES, 1));
+    mixer.setEffect(1, effect(10.0f, MIXER_VOICES, 2));
+    mixer.setEffect(2, effect(10.0f, 1, 0));
+
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        mixer.post(i == 5 ? 1 : 0);
+        mixer.update(0.01f);
+    }
+    CHECK(mixer.activeVoices() == MIXER_VOICES);
+
+    // A higher priority effect takes the oldest of the lowest-priority voices.
+    mixer.post(1);
+    mixer.update(0.01f);
+    CHECK(mixer.stats.stolen == 1);
+    CHECK(mixer.voices[0].effect == 1);
+    CHECK(mixer.voices[5].effect == 1);
+
+    // An equal priority effect steals too, and never a higher priority voice.
+    mixer.post(0);
+    mixer.update(0.01f);
+    CHECK(mixer.stats.stolen == 2);
+    CHECK(mixer.voices[1].effect == 0 && mixer.voices[1].start > 0.1);
+    CHECK(mixer.voices[0].effect == 1 && mixer.voices[5].effect == 1);
+
+    // A lower priority effect finds nothing to take and is dropped.
+    mixer.post(2);
+    mixer.update(0.01f);
+    CHECK(mixer.stats.dropped == 1);
+    CHECK(mixer.stats.played == MIXER_VOICES + 2);
+    CHECK(audio.plays == mixer.stats.played);
+    CHECK(audio.stops == mixer.stats.stolen);
+
+    mixer.stopAll();
+    CHECK(mixer.activeVoices() == 0);
+    CHECK(audio.stops == mixer.stats.stolen + MIXER_VOICES);
+}
+
+static void testQueue() {
+    NullAudioBackend audio;
+    Mixer mixer(audio);
+    mixer.setEffect(0, effect(1.0f, MIXER_VOICES, 0));
+
+    mixer.post(-1);
+    mixer.post(MIXER_EFFECTS);
+    for (int i = 0; i < MIXER_QUEUE_CAPACITY + 5; i++) mixer.post(0);
+    CHECK(mixer.stats.posted == MIXER_QUEUE_CAPACITY + 7);
+    CHECK(mixer.stats.dropped == 7);
+    CHECK(mixer.queueCount == MIXER_QUEUE_CAPACITY);
+
+    // Everything queued in one tick competes for the same voices.
+    mixer.update(0.01f);
+    CHECK(mixer.queueCount == 0);
+    CHECK(mixer.activeVoices() == MIXER_VOICES);
+    CHECK(mixer.stats.played == MIXER_QUEUE_CAPACITY);
+    CHECK(mixer.stats.stolen == MIXER_QUEUE_CAPACITY - MIXER_VOICES);
+
+    // stopAll also forgets requests that have not started yet.
+    mixer.post(0);
+    mixer.stopAll();
+    mixer.update(0.01f);
+    CHECK(mixer.activeVoices() == 0);
+}
+
+int main() {
+    testPolyphony();
+    testStealing();
+    testQueue();
+    return finish("mixer");
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "simulation.h"
+
+// A deterministic input pattern with long runs, single-tick taps and every bit.
+inline InputFrame patternInput(int tick) {
+    InputFrame input;
+    input.moveLeft = tick / 300 % 2 == 0;
+    input.moveRight = !input.moveLeft && tick % 7 != 0;
+    input.moveUp = tick % 500 < 40;
+    input.fire = tick % 45 < 20;
+    input.firePressed = tick % 45 == 0;
+    input.start = tick % 900 == 0;
+    input.pause = tick % 1700 == 850 || tick % 1700 == 900;
+    return input;
+}
@@ -0,0 +1,57 @@
+// Checks for Pool: spawning until full, release during forEach, and slot reuse.
+//
+//   g++ -std=c++17 -O2 -I.. pool.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include "check.h"
+#include "pool.h"
+
+// dense and position must stay inverse permutations with the live items first.
+template <class P>
+static bool poolConsistent(const P& pool) {
+    for (int i = 0; i < P::capacity(); i++) {
+        if (pool.position[pool.dense[i]] != i) return false;
+        if (pool.alive[pool.dense[i]] != (i < pool.count)) return false;
+    }
+    return true;
+}
+
+static void testPool() {
+    Pool<int, 8> pool;
+    int slots[8];
+    for (int i = 0; i < 8; i++) {
+        slots[i] = pool.spawn(i * 10);
+        CHECK(slots[i] >= 0);
+    }
+    CHECK(pool.spawn(99) == -1);
+    CHECK(pool.count == 8);
+
+    pool.release(slots[3]);
+    pool.release(slots[0]);
+    pool.release(slots[0]);
+    CHECK(pool.count == 6);
+    CHECK(!pool.isAlive(slots[3]) && !pool.isAlive(slots[0]));
+    CHECK(poolConsistent(pool));
+
+    int visited = 0;
+    int sum = 0;
+    pool.forEach([&](int index, int value) {
+        visited++;
+        sum += value;
+        if (value == 70) pool.release(index);
+    });
+    CHECK(visited == 6);
+    CHECK(sum == 10 + 20 + 40 + 50 + 60 + 70);
+    CHECK(pool.count == 5);
+    CHECK(poolConsistent(pool));
+
+    // A freed slot is handed out again before the pool reports full.
+    int reused = pool.spawn(5);
+    CHECK(reused == slots[7]);
+    CHECK(pool[reused] == 5);
+    CHECK(poolConsistent(pool));
+}
+
+int main() {
+    testPool();
+    return finish("pool");
+}
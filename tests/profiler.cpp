@@ -0,0 +1,112 @@
+// Checks for the profiler: rolling histogram percentiles against the exact
+// order statistic, the window forgetting old samples, and merging section
+// times from another thread.
+//
+//   g++ -std=c++17 -O2 -DINVADERS_PROFILE=1 -I.. profiler.cpp ../simulation.cpp
+//       ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp
+//       ../savestate.cpp
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "check.h"
+#include "profiler.h"
+#include "rng.h"
+
+// The rank percentile() aims for, taken from the sorted samples.
+static std::uint32_t exactPercentile(std::vector<std::uint32_t> values, float fraction) {
+    std::sort(values.begin(), values.end());
+    int rank = std::max(static_cast<int>(fraction * values.size() + 0.5f), 1);
+    return values[rank - 1];
+}
+
+static void testPercentiles() {
+    RollingHistogram histogram;
+    CHECK(histogram.percentile(0.5f) == 0);
+    CHECK(histogram.max() == 0);
+
+    // Below 16 every value has its own bucket.
+    for (std::uint32_t value = 0; value < 16; value++) histogram.add(value);
+    CHECK(histogram.percentile(0.5f) == 7);
+    CHECK(histogram.percentile(1.0f) == 15);
+    CHECK(histogram.percentile(0.0f) == 0);
+    CHECK(histogram.max() == 15);
+
+    // Wider values land within one bucket, about 6%, of the exact answer.
+    Rng rng(21);
+    const float fractions[] = { 0.1f, 0.5f, 0.9f, 0.99f, 1.0f };
+    bool close = true;
+    for (int round = 0; round < 50; round++) {
+        RollingHistogram wide;
+        std::vector<std::uint32_t> values;
+        int count = 1 + static_cast<int>(rng.below(PROFILE_WINDOW));
+        for (int i = 0; i < count; i++) {
+            // Spread over every power of two up to the top of the range.
+            std::uint32_t value = rng.next() >> rng.below(32);
+            values.push_back(value);
+            wide.add(value);
+        }
+        for (float fraction : fractions) {
+            double exact = exactPercentile(values, fraction);
+            double estimate = wide.percentile(fraction);
+            close = close && std::fabs(estimate - exact) <= std::max(exact * 0.0625, 1.0);
+        }
+        close = close && wide.max() == *std::max_element(values.begin(), values.end());
+    }
+    CHECK(close);
+}
+
+static void testWindow() {
+    RollingHistogram histogram;
+    for (int i = 0; i < PROFILE_WINDOW; i++) histogram.add(100000);
+    CHECK(histogram.count == PROFILE_WINDOW);
+
+    // Once a full window of newer samples is in, the old ones are gone.
+    for (int i = 0; i < PROFILE_WINDOW - 1; i++) histogram.add(1000);
+    CHECK(histogram.percentile(0.99f) <= 1063);
+    CHECK(histogram.percentile(1.0f) > 90000);
+    histogram.add(1000);
+    CHECK(histogram.percentile(1.0f) <= 1063);
+    CHECK(histogram.max() == 1000);
+    CHECK(histogram.count == PROFILE_WINDOW);
+
+    int total = 0;
+    for (int bucket = 0; bucket < PROFILE_BUCKETS; bucket++) total += histogram.buckets[bucket];
+    CHECK(total == PROFILE_WINDOW);
+}
+
+// Section times flushed on one thread reach another thread's profiler once,
+// however many totals it never saw in between.
+static void testMerge() {
+    Profiler worker(0);
+    Profiler frames(0);
+    std::uint64_t totals[PROFILE_SECTION_COUNT] = {};
+    std::uint64_t seen[PROFILE_SECTION_COUNT] = {};
+
+    worker.add(PROFILE_MOVE_ALIENS, 100);
+    worker.flush(totals);
+    CHECK(worker.current[PROFILE_MOVE_ALIENS] == 0);
+    worker.add(PROFILE_MOVE_ALIENS, 50);
+    worker.add(PROFILE_CLEANUP, 7);
+    worker.flush(totals);
+    frames.add(PROFILE_RENDER, 1000);
+    frames.merge(totals, seen);
+    CHECK(frames.current[PROFILE_MOVE_ALIENS] == 150);
+    CHECK(frames.current[PROFILE_CLEANUP] == 7);
+    CHECK(frames.current[PROFILE_RENDER] == 1000);
+
+    frames.endFrame();
+    frames.merge(totals, seen);
+    CHECK(frames.current[PROFILE_MOVE_ALIENS] == 0);
+    worker.add(PROFILE_MOVE_ALIENS, 20);
+    worker.flush(totals);
+    frames.merge(totals, seen);
+    CHECK(frames.current[PROFILE_MOVE_ALIENS] == 20);
+    CHECK(frames.current[PROFILE_FRAME] == 0);
+}
+
+int main() {
+    testPercentiles();
+    testWindow();
+    testMerge();
+    return finish("profiler");
+}
@@ -0,0 +1,118 @@
+// Checks for replay logs: input packing, a long recording played back to the
+// same final hash, and corrupt run lengths.
+//
+//   g++ -std=c++17 -O2 -I.. replay.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "check.h"
+#include "pattern.h"
+#include "replay.h"
+
+static void testReplay() {
+    for (int mask = 0; mask < 256; mask++) {
+        CHECK(packInput(unpackInput(static_cast<std::uint8_t>(mask))) == mask);
+    }
+
+    const char* path = "tests_replay.bin";
+    const int ticks = 5000;
+    Simulation recorded(77);
+    InputRecorder recorder;
+    CHECK(recorder.open(path, 77));
+    for (int tick = 0; tick < ticks; tick++) {
+        InputFrame input = patternInput(tick);
+        recorder.record(input);
+        recorded.step(input, TICK_SECONDS);
+    }
+    // A run longer than one LEB128 byte holds.
+    for (int tick = 0; tick < 1000; tick++) {
+        InputFrame idle;
+        recorder.record(idle);
+        recorded.step(idle, TICK_SECONDS);
+    }
+    CHECK(recorder.close(hashSimulation(recorded)));
+
+    InputReplay replay;
+    CHECK(replay.open(path));
+    CHECK(replay.seed == 77);
+    CHECK(replay.tickCount == ticks + 1000);
+    Simulation replayed(replay.seed);
+    int tick = 0;
+    bool same = true;
+    InputFrame input;
+    while (replay.next(input)) {
+        InputFrame expected = tick < ticks ? patternInput(tick) : InputFrame();
+        same = same && packInput(input) == packInput(expected);
+        replayed.step(input, TICK_SECONDS);
+        tick++;
+    }
+    CHECK(same);
+    CHECK(tick == ticks + 1000);
+    CHECK(replay.finished());
+    CHECK(hashSimulation(replayed) == replay.finalHash);
+    std::remove(path);
+}
+
+
+// Writes a log whose body is the given bytes, behind the header of a real
+// recording with its tick count raised so the body is read to the end.
+static bool writeBody(const char* path, const std::vector<std::uint8_t>& body) {
+    InputRecorder recorder;
+    if (!recorder.open(path, 1)) return false;
+    recorder.close(0);
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    // tickCount sits after "INVR", the version, the tick rate and the seed.
+    for (int i = 0; i < 8; i++) bytes[16 + i] = static_cast<char>(0xff);
+    bytes.insert(bytes.end(), body.begin(), body.end());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+    return static_cast<bool>(out);
+}
+
+// Counts the ticks a log yields before next() gives up.
+static int readTicks(const char* path) {
+    InputReplay replay;
+    if (!replay.open(path)) return -1;
+    int ticks = 0;
+    InputFrame input;
+    while (replay.next(input)) ticks++;
+    return ticks;
+}
+
+static void testCorruptRuns() {
+    const char* path = "tests_replay_corrupt.bin";
+
+    // The longest valid length, five bytes.
+    CHECK(writeBody(path, { 0x01, 0x82, 0x80, 0x80, 0x80, 0x00, 0x01, 0x03 }));
+    CHECK(readTicks(path) == 5);
+
+    // Continuation bits past the fifth byte would shift beyond 32 bits.
+    CHECK(writeBody(path, { 0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 }));
+    CHECK(readTicks(path) == 0);
+
+    // A length cut off by the end of the file, and one of zero.
+    CHECK(writeBody(path, { 0x01, 0x02, 0x01, 0x85 }));
+    CHECK(readTicks(path) == 2);
+    CHECK(writeBody(path, { 0x01, 0x00 }));
+    CHECK(readTicks(path) == 0);
+    std::remove(path);
+}
+
+// Two games that differ only in score must not hash the same.
+static void testHashScore() {
+    Simulation a(9);
+    Simulation b(9);
+    b.score += 10;
+    CHECK(hashSimulation(a) != hashSimulation(b));
+}
+
+int main() {
+    testReplay();
+    testCorruptRuns();
+    testHashScore();
+    return finish("replay");
+}
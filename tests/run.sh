@@ -0,0 +1,47 @@
+#!/bin/sh
+# Builds and runs each headless check program, then the benchmark's
+# allocation check: bench --strict fails if any scenario allocates once warmed
+# up. The checks given $sfml and the bench link SFML; everything else needs
+# only a C++17 compiler.
+#
+#   tests/run.sh
+set -e
+root="$(cd "$(dirname "$0")/.." && pwd)"
+build="${BUILD_DIR:-$root/tests/build}"
+cxx="${CXX:-g++}"
+sfml="-lsfml-graphics -lsfml-window -lsfml-audio -lsfml-system"
+core="../simulation.cpp ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp"
+mkdir -p "$build"
+
+# run_check NAME [SOURCES AND FLAGS...] builds tests/NAME.cpp with the
+# simulation core and runs it from the build directory.
+run_check() {
+    name="$1"
+    shift
+    $cxx -std=c++17 -O2 -I.. "$name.cpp" $core "$@" -o "$build/$name"
+    (cd "$build" && "./$name")
+}
+
+cd "$root/tests"
+run_check pool
+run_check formation
+run_check mixer ../mixer.cpp
+run_check profiler -DINVADERS_PROFILE=1
+run_check replay
+run_check triplebuffer -pthread
+run_check bunker
+run_check savestate
+run_check assetpack ../assetpack.cpp
+run_check collision
+run_check telemetry ../telemetry.cpp -pthread
+
+run_check hud ../hud.cpp ../batch.cpp $sfml
+run_check input ../input.cpp ../simthread.cpp ../sfmlaudio.cpp ../mixer.cpp ../telemetry.cpp \
+    ../resources.cpp ../assetpack.cpp -pthread $sfml
+
+cd "$root/tools"
+$cxx -std=c++17 -O2 -DNDEBUG -DINVADERS_PROFILE=1 -DINVADERS_TRACK_ALLOCS=1 -I.. bench.cpp \
+    ../simulation.cpp ../formation.cpp ../collision.cpp ../profiler.cpp ../render.cpp \
+    ../batch.cpp ../resources.cpp ../assetpack.cpp ../alloctrack.cpp ../bunker.cpp \
+    ../mixer.cpp ../sfmlaudio.cpp $sfml -o "$build/bench"
+"$build/bench" --strict --ticks 5000
@@ -0,0 +1,171 @@
+// Checks for save states and rewind: round trips that play on identically,
+// rejection of corrupt quicksaves, and rewinding across keyframes.
+//
+//   g++ -std=c++17 -O2 -I.. savestate.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "check.h"
+#include "pattern.h"
+#include "replay.h"
+#include "savestate.h"
+#include "simulation.h"
+
+static void playTicks(Simulation& sim, int first, int count) {
+    for (int tick = first; tick < first + count; tick++) {
+        sim.step(patternInput(tick), TICK_SECONDS);
+    }
+}
+
+static void testSnapshot() {
+    Simulation sim(31);
+    playTicks(sim, 0, 3000);
+
+    GameSnapshot snapshot;
+    CHECK(captureSnapshot(sim, snapshot));
+    const char* path = "tests_snapshot.bin";
+    CHECK(saveSnapshot(path, snapshot));
+    GameSnapshot loaded;
+    CHECK(loadSnapshot(path, loaded));
+    CHECK(std::memcmp(&snapshot, &loaded, sizeof(snapshot)) == 0);
+
+    // A restored game carries on exactly like the original.
+    Simulation restored(1);
+    restoreSnapshot(loaded, restored);
+    CHECK(hashSimulation(restored) == hashSimulation(sim));
+    playTicks(sim, 3000, 2000);
+    playTicks(restored, 3000, 2000);
+    CHECK(hashSimulation(restored) == hashSimulation(sim));
+
+    // Corrupt sizes and indices are rejected instead of restored.
+    GameSnapshot corrupt = snapshot;
+    corrupt.shooterColumns[0] = 200;
+    corrupt.shooterCount = 1;
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+    corrupt = snapshot;
+    corrupt.rows = 1000;
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+    corrupt = snapshot;
+    corrupt.alienBolts.dense[1] = corrupt.alienBolts.dense[0];
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+
+    // World extents size the bolt grid, so they must be finite and bounded.
+    corrupt = snapshot;
+    corrupt.worldWidth = std::nanf("");
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+    corrupt = snapshot;
+    corrupt.worldHeight = 1e30f;
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+    corrupt = snapshot;
+    corrupt.barrierY = -1.0f;
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+    std::remove(path);
+}
+
+// Clears every living alien in one column of the snapshot; returns the column.
+static int emptyColumn(GameSnapshot& snapshot) {
+    int column = -1;
+    for (int slot = 0; slot < snapshot.rows * snapshot.columns && column < 0; slot++) {
+        if (snapshot.alive >> slot & 1) column = slot % snapshot.columns;
+    }
+    for (int row = 0; row < snapshot.rows; row++) {
+        snapshot.alive &= ~(std::uint64_t(1) << (row * snapshot.columns + column));
+    }
+    return column;
+}
+
+// The shooter list has to match the living aliens column for column; a
+// shooter in an empty column would index row -1 when it fires.
+static void testShooterColumns() {
+    Simulation sim(31);
+    playTicks(sim, 0, 3000);
+    GameSnapshot snapshot;
+    CHECK(captureSnapshot(sim, snapshot));
+    CHECK(snapshot.shooterCount > 1);
+    const char* path = "tests_snapshot.bin";
+    GameSnapshot loaded;
+
+    GameSnapshot corrupt = snapshot;
+    int column = emptyColumn(corrupt);
+    CHECK(column >= 0);
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+
+    // Dropping that column from the list makes it a consistent save again.
+    GameSnapshot fixed = corrupt;
+    for (int i = 0; i < fixed.shooterCount; i++) {
+        if (fixed.shooterColumns[i] == column) fixed.shooterColumns[i] = fixed.shooterColumns[--fixed.shooterCount];
+    }
+    CHECK(saveSnapshot(path, fixed));
+    CHECK(loadSnapshot(path, loaded));
+    Simulation restored(1);
+    restoreSnapshot(loaded, restored);
+    playTicks(restored, 3000, 2000);
+    CHECK(restored.formation.lowestRow[column] == -1);
+
+    // A living column missing from the list is rejected as well.
+    corrupt = snapshot;
+    corrupt.shooterCount--;
+    CHECK(saveSnapshot(path, corrupt));
+    CHECK(!loadSnapshot(path, loaded));
+    std::remove(path);
+}
+
+static void testRewind() {
+    const int ticks = 400;
+    Simulation sim(5);
+    RewindBuffer rewind(1024 * 1024, ticks);
+    std::vector<GameSnapshot> history(ticks);
+    for (int tick = 0; tick < ticks; tick++) {
+        sim.step(patternInput(tick), TICK_SECONDS);
+        CHECK(captureSnapshot(sim, history[tick]));
+        rewind.push(history[tick]);
+    }
+    CHECK(rewind.size() == ticks);
+
+    // Stepping back lands on exactly the snapshot pushed that many ticks ago,
+    // across keyframes and the deltas between them.
+    GameSnapshot snapshot;
+    int newest = ticks - 1;
+    const int steps[] = { 1, 7, 60, 61, 100 };
+    for (int step : steps) {
+        CHECK(rewind.rewind(step, snapshot));
+        newest -= step;
+        CHECK(std::memcmp(&snapshot, &history[newest], sizeof(snapshot)) == 0);
+        CHECK(rewind.size() == newest + 1);
+    }
+
+    // Pushing after a rewind continues from there.
+    Simulation resumed(1);
+    restoreSnapshot(snapshot, resumed);
+    GameSnapshot next;
+    resumed.step(InputFrame(), TICK_SECONDS);
+    CHECK(captureSnapshot(resumed, next));
+    rewind.push(next);
+    CHECK(rewind.rewind(0, snapshot));
+    CHECK(std::memcmp(&snapshot, &next, sizeof(snapshot)) == 0);
+
+    // A small budget keeps only the newest ticks but stays exact.
+    RewindBuffer small(16 * 1024, ticks);
+    for (int tick = 0; tick < ticks; tick++) small.push(history[tick]);
+    int kept = small.size();
+    CHECK(kept > 0 && kept < ticks);
+    CHECK(small.rewind(kept - 1, snapshot));
+    CHECK(std::memcmp(&snapshot, &history[ticks - kept], sizeof(snapshot)) == 0);
+}
+
+int main() {
+    testSnapshot();
+    testShooterColumns();
+    testRewind();
+
+    return finish("savestate");
+}
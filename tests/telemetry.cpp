@@ -0,0 +1,163 @@
+// Checks for telemetry: a full ring dropping and counting, a log written and
+// read back, and the state kept between steps across jumps and new games.
+//
+//   g++ -std=c++17 -O2 -pthread -I.. telemetry.cpp ../telemetry.cpp ../simulation.cpp
+//       ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp
+//       ../savestate.cpp
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "check.h"
+#include "telemetry.h"
+
+static TelemetryRecord makeRecord(std::uint32_t tick) {
+    TelemetryRecord record = {};
+    record.tick = tick;
+    record.type = TELEMETRY_KILLS;
+    return record;
+}
+
+static void testRingOverflow() {
+    TelemetryRing ring;
+    bool accepted = true;
+    for (int i = 0; i < TELEMETRY_RING_SIZE; i++) {
+        accepted = accepted && ring.push(makeRecord(i));
+    }
+    CHECK(accepted);
+    CHECK(!ring.push(makeRecord(TELEMETRY_RING_SIZE)));
+    CHECK(!ring.push(makeRecord(TELEMETRY_RING_SIZE)));
+    CHECK(ring.dropped.load() == 2);
+
+    // Once the consumer frees a slot the producer sees it.
+    ring.tail.store(1);
+    CHECK(ring.push(makeRecord(TELEMETRY_RING_SIZE + 1)));
+    CHECK(ring.records[0].tick == TELEMETRY_RING_SIZE + 1);
+    CHECK(!ring.push(makeRecord(TELEMETRY_RING_SIZE + 2)));
+    CHECK(ring.dropped.load() == 3);
+}
+
+// Reads a whole log back; false if the header does not match this build.
+static bool readLog(const char* path, TelemetryHeader& header, std::vector<TelemetryRecord>& records) {
+    std::ifstream file(path, std::ios::binary);
+    if (!readTelemetryHeader(file, header)) return false;
+    if (header.version != TELEMETRY_VERSION || header.recordSize != sizeof(TelemetryRecord)) return false;
+    records.clear();
+    TelemetryRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+static void testRoundTrip() {
+    const char* path = "tests_telemetry.log";
+    {
+        Telemetry telemetry;
+        CHECK(telemetry.start(path, 4321));
+        telemetry.record(TELEMETRY_SIMULATION, TELEMETRY_KILLS, 10, 2, 3, 150);
+        telemetry.record(TELEMETRY_SIMULATION, TELEMETRY_LIFE_LOST, 11, 2, -1);
+        telemetry.record(TELEMETRY_FRAMES, TELEMETRY_FRAME, 12, 3, 16667, PLAY_STATE);
+        telemetry.stop();
+    }
+
+    TelemetryHeader header;
+    std::vector<TelemetryRecord> records;
+    CHECK(readLog(path, header, records));
+    CHECK(header.seed == 4321);
+    CHECK(header.startUnixNanoseconds > 0);
+    // Channels are written in order, so the frame comes last.
+    CHECK(records.size() == 3);
+    if (records.size() == 3) {
+        CHECK(records[0].type == TELEMETRY_KILLS && records[0].tick == 10 && records[0].wave == 2);
+        CHECK(records[0].value0 == 3 && records[0].value1 == 150);
+        CHECK(records[1].type == TELEMETRY_LIFE_LOST && records[1].value0 == -1 && records[1].value1 == 0);
+        CHECK(records[2].type == TELEMETRY_FRAME && records[2].wave == 3);
+        CHECK(records[2].value0 == 16667 && records[2].value1 == PLAY_STATE);
+        CHECK(records[0].time <= records[1].time && records[1].time <= records[2].time);
+    }
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "INVR not a telemetry log";
+    CHECK(!readLog(path, header, records));
+    std::remove(path);
+}
+
+// Records pushed into a full ring reach the log as one dropped record.
+static void testDroppedRecord() {
+    const char* path = "tests_telemetry_dropped.log";
+    {
+        Telemetry telemetry;
+        for (int i = 0; i < TELEMETRY_RING_SIZE + 5; i++) {
+            telemetry.record(TELEMETRY_FRAMES, TELEMETRY_FRAME, i, 1, 0);
+        }
+        CHECK(telemetry.start(path, 1));
+        telemetry.stop();
+    }
+
+    TelemetryHeader header;
+    std::vector<TelemetryRecord> records;
+    CHECK(readLog(path, header, records));
+    CHECK(records.size() == TELEMETRY_RING_SIZE + 1u);
+    if (!records.empty()) {
+        const TelemetryRecord& lost = records.back();
+        CHECK(lost.type == TELEMETRY_DROPPED);
+        CHECK(lost.value0 == 5 && lost.value1 == TELEMETRY_FRAMES);
+        CHECK(records[TELEMETRY_RING_SIZE - 1].tick == TELEMETRY_RING_SIZE - 1);
+    }
+    std::remove(path);
+}
+
+// The records recordStep() pushed on the simulation channel since last time.
+static int countNew(Telemetry& telemetry, TelemetryType type, std::uint32_t& seen) {
+    TelemetryRing& ring = telemetry.channels[TELEMETRY_SIMULATION];
+    std::uint32_t head = ring.head.load();
+    int count = 0;
+    for (; seen != head; seen++) {
+        if (ring.records[seen & (TELEMETRY_RING_SIZE - 1)].type == type) count++;
+    }
+    return count;
+}
+
+static void testSync() {
+    Telemetry telemetry;
+    std::uint32_t seen = 0;
+    Simulation sim(5);
+    sim.gameState = PLAY_STATE;
+    sim.wave = 3;
+    telemetry.sync(sim);
+    telemetry.recordStep(sim);
+    CHECK(countNew(telemetry, TELEMETRY_STATE_CHANGE, seen) == 0);
+
+    // A quickload or rewind to fewer lives and another wave loses nothing.
+    Simulation loaded(5);
+    loaded.gameState = PAUSE_STATE;
+    loaded.lives = 1;
+    loaded.wave = 2;
+    loaded.clock.tick = 40;
+    telemetry.sync(loaded);
+    telemetry.recordStep(loaded);
+    CHECK(countNew(telemetry, TELEMETRY_LIFE_LOST, seen) == 0);
+    CHECK(telemetry.waveStartTick == 40);
+
+    loaded.lives = 0;
+    loaded.gameState = DEFEAT_STATE;
+    telemetry.recordStep(loaded);
+    CHECK(countNew(telemetry, TELEMETRY_LIFE_LOST, seen) == 1);
+
+    // The next game is measured against full lives, not the last game's none.
+    Simulation next(6);
+    next.gameState = PLAY_STATE;
+    next.lives = START_LIVES - 1;
+    telemetry.recordStep(next);
+    std::uint32_t stepStart = seen;
+    CHECK(countNew(telemetry, TELEMETRY_LIFE_LOST, seen) == 1);
+    seen = stepStart;
+    CHECK(countNew(telemetry, TELEMETRY_WAVE_STARTED, seen) == 1);
+}
+
+int main() {
+    testRingOverflow();
+    testRoundTrip();
+    testDroppedRecord();
+    testSync();
+    return finish("telemetry");
+}
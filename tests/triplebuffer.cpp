@@ -0,0 +1,85 @@
+// Checks for TripleBuffer: what acquire() reports on one thread, and a
+// producer thread handing over numbered slots that the reader must see whole
+// and in order.
+//
+//   g++ -std=c++17 -O2 -I.. triplebuffer.cpp ../simulation.cpp ../formation.cpp
+//       ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp ../savestate.cpp
+//       -pthread
+#include <thread>
+#include "check.h"
+#include "triplebuffer.h"
+
+struct Slot {
+    int number = 0;
+    int copy[64] = {};
+};
+
+static void fill(Slot& slot, int number) {
+    slot.number = number;
+    for (int& value : slot.copy) value = number;
+}
+
+static bool whole(const Slot& slot) {
+    for (int value : slot.copy) {
+        if (value != slot.number) return false;
+    }
+    return true;
+}
+
+static void testSingleThread() {
+    TripleBuffer<Slot> buffer;
+    CHECK(!buffer.acquire());
+
+    fill(buffer.back(), 1);
+    buffer.publish();
+    CHECK(buffer.acquire());
+    CHECK(buffer.front().number == 1);
+    CHECK(!buffer.acquire());
+    CHECK(buffer.front().number == 1);
+
+    // Only the newest of several publishes reaches the reader, and the
+    // writer never gets the slot the reader holds.
+    for (int number = 2; number <= 5; number++) {
+        CHECK(&buffer.back() != &buffer.front());
+        fill(buffer.back(), number);
+        buffer.publish();
+    }
+    CHECK(buffer.acquire());
+    CHECK(buffer.front().number == 5);
+    CHECK(!buffer.acquire());
+}
+
+static void testHandoff() {
+    const int count = 200000;
+    TripleBuffer<Slot> buffer;
+    std::thread writer([&buffer] {
+        for (int number = 1; number <= count; number++) {
+            fill(buffer.back(), number);
+            buffer.publish();
+        }
+    });
+
+    int last = 0;
+    int acquired = 0;
+    bool ordered = true;
+    bool complete = true;
+    while (last < count) {
+        if (!buffer.acquire()) continue;
+        const Slot& slot = buffer.front();
+        complete = complete && whole(slot);
+        ordered = ordered && slot.number > last;
+        last = slot.number;
+        acquired++;
+    }
+    writer.join();
+    CHECK(ordered);
+    CHECK(complete);
+    CHECK(last == count);
+    CHECK(acquired > 0);
+}
+
+int main() {
+    testSingleThread();
+    testHandoff();
+    return finish("triplebuffer");
+}
@@ -0,0 +1,279 @@
+// Headless stress benchmark for the simulation core.
+//
+//   g++ -std=c++17 -O2 -DNDEBUG -DINVADERS_PROFILE=1 -DINVADERS_TRACK_ALLOCS=1 -I.. bench.cpp
+//       ../simulation.cpp ../formation.cpp ../collision.cpp ../profiler.cpp ../render.cpp
+//       ../batch.cpp ../resources.cpp ../assetpack.cpp ../alloctrack.cpp ../bunker.cpp
+//       ../mixer.cpp ../sfmlaudio.cpp -lsfml-graphics -lsfml-window -lsfml-audio -lsfml-system
+//
+//   bench [--ticks N] [--scenario NAME] [--render] [--strict]
+//
+// --strict exits non-zero if any scenario allocates after warm-up.
+//
+// Run from the directory that holds the assets or assets.pak when using --render.
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "alloctrack.h"
+#include "profiler.h"
+#include "render.h"
+#include "resources.h"
+#include "rng.h"
+#include "sfmlaudio.h"
+#include "simulation.h"
+
+struct Scenario {
+    const char* name;
+    int rows;
+    int columns;
+    int playerBolts;    // kept in flight by the harness, spread over the arena
+    int alienBolts;
+    bool massacre;      // one bolt under every living column, every tick
+    bool sounds;        // every step's events go through a mixer on a NullAudioBackend
+};
+
+static const Scenario scenarios[] = {
+    { "formation_3x10", 3, 10, 0, 0, false, false },
+    { "formation_10x30", 10, 30, 0, 0, false, false },
+    { "formation_30x50", 30, 50, 0, 0, false, false },
+    { "formation_100x100", 100, 100, 0, 0, false, false },
+    { "storm_3x10_200", 3, 10, 200, 200, false, false },
+    { "storm_30x50_250", 30, 50, 250, 250, false, false },
+    { "massacre_30x50", 30, 50, 0, 0, true, false },
+    { "massacre_100x100", 100, 100, 0, 0, true, false },
+    { "massacre_30x50_sound", 30, 50, 0, 0, true, true },
+};
+
+struct Groups {
+    double movement = 0.0;
+    double collision = 0.0;
+    double cleanup = 0.0;
+};
+
+struct Result {
+    long long ticks = 0;
+    double seconds = 0.0;
+    double entityTicks = 0.0;
+    std::uint64_t allocations = 0;
+    Groups groups;
+    double renderSeconds = 0.0;
+    long long renderedFrames = 0;
+};
+
+static void setupArena(Simulation& sim, const Scenario& scenario) {
+    sim.formationRows = scenario.rows;
+    sim.formationColumns = scenario.columns;
+    sim.worldWidth = std::max(WORLD_WIDTH, 200.0f + scenario.columns * ALIEN_SPACING + 200.0f);
+    sim.barrierY = std::max(BARRIER_Y, 50.0f + scenario.rows * ALIEN_SPACING + 400.0f);
+    sim.worldHeight = sim.barrierY + (WORLD_HEIGHT - BARRIER_Y);
+    sim.maxPlayerBolts = PLAYER_BOLT_CAPACITY;
+    sim.reset();
+
+    InputFrame start;
+    start.start = true;
+    sim.step(start, 0.0f);
+}
+
+static void feedBolts(Simulation& sim, const Scenario& scenario, Rng& rng) {
+    while (sim.playerBolts.count < scenario.playerBolts) {
+        Bolt bolt;
+        bolt.x = static_cast<float>(rng.below(static_cast<std::uint32_t>(sim.worldWidth)));
+        bolt.y = sim.barrierY;
+        if (sim.playerBolts.spawn(bolt) < 0) break;
+    }
+    while (sim.alienBolts.count < scenario.alienBolts) {
+        Bolt bolt;
+        bolt.x = static_cast<float>(rng.below(static_cast<std::uint32_t>(sim.worldWidth)));
+        bolt.y = 0.0f;
+        if (sim.alienBolts.spawn(bolt) < 0) break;
+    }
+
+    if (scenario.massacre && sim.formation.livingCount > 0) {
+        const Formation& formation = sim.formation;
+        float y = formation.bottomEdge() + ALIEN_SIZE + 4.0f;
+        for (int i = 0; i < formation.shooterCount(); i++) {
+            Bolt bolt;
+            bolt.x = formation.x[formation.shooterSlot(i)] + ALIEN_SIZE / 2 - BOLT_WIDTH / 2;
+            bolt.y = y;
+            if (sim.playerBolts.spawn(bolt) < 0) break;
+        }
+    }
+}
+
+static Result run(const Scenario& scenario, long long ticks, PlayRenderer* renderer, sf::RenderTexture* target) {
+    const float dt = 1.0f / TICKS_PER_SECOND;
+    Simulation sim(12345);
+    Rng rng(67890);
+    setupArena(sim, scenario);
+
+    InputFrame input;
+    input.fire = true;
+    input.firePressed = true;
+
+    // Every effect gets the same length and polyphony, so a busy wave keeps
+    // the voices full and the mixer stealing.
+    NullAudioBackend audio;
+    Mixer mixer(audio);
+    for (int effect = 0; effect < MIXER_EFFECTS; effect++) {
+        EffectConfig config;
+        config.duration = 0.5f;
+        config.maxVoices = 4;
+        config.priority = effect;
+        mixer.setEffect(effect, config);
+    }
+
+    // Warm up so pools and vectors reach their steady-state size.
+    for (int i = 0; i < 240; i++) {
+        feedBolts(sim, scenario, rng);
+        sim.step(input, dt);
+        if (scenario.sounds) {
+            postSounds(sim, mixer);
+            mixer.update(dt);
+        }
+    }
+
+    Result result;
+#if INVADERS_PROFILE
+    Profiler& prof = profiler();
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) prof.current[i] = 0;
+#endif
+    std::uint64_t allocationsBefore = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+
+    for (long long tick = 0; tick < ticks; tick++) {
+        feedBolts(sim, scenario, rng);
+
+        input.moveLeft = (tick / 240) % 2 == 0;
+        input.moveRight = !input.moveLeft;
+        input.start = sim.gameState != PLAY_STATE;
+        sim.step(input, dt);
+        if (scenario.sounds) {
+            postSounds(sim, mixer);
+            mixer.update(dt);
+        }
+
+        result.entityTicks += sim.formation.livingCount + sim.formation.dyingCount + sim.playerBolts.count + sim.alienBolts.count;
+
+#if INVADERS_PROFILE
+        result.groups.movement += prof.current[PROFILE_MOVE_ALIENS] + prof.current[PROFILE_FIRE_BOLT] +
+            prof.current[PROFILE_SHIP_MOVEMENT] + prof.current[PROFILE_ALIEN_FIRE];
+        result.groups.collision += prof.current[PROFILE_ALIEN_COLLISIONS] + prof.current[PROFILE_SHIP_COLLISIONS] +
+            prof.current[PROFILE_BOLT_COLLISIONS] + prof.current[PROFILE_BUNKER_COLLISIONS];
+        result.groups.cleanup += prof.current[PROFILE_CLEANUP];
+        for (int i = 0; i < PROFILE_SECTION_COUNT; i++) prof.current[i] = 0;
+#endif
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = allocationCount() - allocationsBefore;
+    result.ticks = ticks;
+
+    if (renderer && target) {
+        long long frames = std::max(1LL, ticks / 2);
+        auto renderStart = std::chrono::steady_clock::now();
+        for (long long frame = 0; frame < frames; frame++) {
+            sim.step(input, dt);
+            renderer->build(sim);
+            target->clear();
+            renderer->draw(*target);
+            target->display();
+        }
+        result.renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+        result.renderedFrames = frames;
+    }
+    return result;
+}
+
+static void report(const Scenario& scenario, const Result& result) {
+    double entities = result.entityTicks / result.ticks;
+    double perEntity = entities > 0 ? 1.0 / (result.entityTicks) : 0.0;
+    std::printf("%-20s %10.0f %9.0f %9.2f %9.2f %9.2f %9.3f",
+        scenario.name,
+        result.ticks / result.seconds,
+        entities,
+        result.groups.movement * perEntity,
+        result.groups.collision * perEntity,
+        result.groups.cleanup * perEntity,
+        static_cast<double>(result.allocations) / result.ticks);
+    if (result.renderedFrames > 0) {
+        std::printf(" %10.1f", result.renderSeconds * 1e6 / result.renderedFrames);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    long long ticks = 20000;
+    const char* only = nullptr;
+    bool render = false;
+    bool strict = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--render") == 0) {
+            render = true;
+        }
+        else if (std::strcmp(argv[i], "--strict") == 0) {
+            strict = true;
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--ticks N] [--scenario NAME] [--render] [--strict]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (ticks <= 0) ticks = 1;
+
+    Resources* resources = nullptr;
+    PlayRenderer* renderer = nullptr;
+    sf::RenderTexture* target = nullptr;
+    if (render) {
+        resources = new Resources;
+        openAssets(*resources, "");
+        if (!loadResources(*resources)) {
+            for (const auto& file : resources->failures) {
+                std::fprintf(stderr, "Failed to load %s\n", file.c_str());
+            }
+        }
+        target = new sf::RenderTexture;
+        if (target->create(static_cast<unsigned>(WORLD_WIDTH), static_cast<unsigned>(WORLD_HEIGHT))) {
+            renderer = new PlayRenderer(*resources);
+        }
+        else {
+            std::fprintf(stderr, "No offscreen render target available; skipping draw timings\n");
+        }
+    }
+
+#if !INVADERS_PROFILE
+    std::fprintf(stderr, "Built without INVADERS_PROFILE; per-phase columns will read 0\n");
+#endif
+#if !INVADERS_TRACK_ALLOCS
+    std::fprintf(stderr, "Built without INVADERS_TRACK_ALLOCS; allocs/t will read 0\n");
+    if (strict) return 1;
+#endif
+    std::printf("%-20s %10s %9s %9s %9s %9s %9s%s\n", "scenario", "ticks/s", "entities",
+        "move ns/e", "coll ns/e", "clean ns/e", "allocs/t", renderer ? "  draw us/f" : "");
+
+    int failures = 0;
+    for (const auto& scenario : scenarios) {
+        if (only && std::strcmp(only, scenario.name) != 0) continue;
+        Result result = run(scenario, ticks, renderer, target);
+        report(scenario, result);
+        if (strict && result.allocations > 0) failures++;
+    }
+
+    delete renderer;
+    delete target;
+    delete resources;
+    if (failures > 0) {
+        std::fprintf(stderr, "%d scenario(s) allocated after warm-up\n", failures);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/sh
+# Build step for the asset pack: compiles the packer and writes assets.pak
+# into the repository root from the loose assets there. Copy assets.pak next
+# to the game executable; without it the game loads the loose files instead.
+# Rerun whenever an asset changes.
+#
+#   tools/pack-assets.sh [OUTPUT]
+set -e
+root="$(cd "$(dirname "$0")/.." && pwd)"
+output="${1:-$root/assets.pak}"
+# The packer runs from the root, so a relative OUTPUT is resolved here first.
+case "$output" in
+    /*) ;;
+    *) output="$(pwd)/$output" ;;
+esac
+
+${CXX:-g++} -std=c++17 -O2 -I"$root" "$root/tools/packer.cpp" "$root/assetpack.cpp" -o "$root/tools/packer"
+
+cd "$root"
+tools/packer "$output" Arcade.ttf ComicSans.ttf RetroGame.ttf alien-strip1.png \
+    ship.png ship-strip.png pew2.wav blast1.wav pop1.wav blast2.wav
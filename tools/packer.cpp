@@ -0,0 +1,122 @@
+// Builds the asset pack the game maps at startup.
+//
+//   g++ -std=c++17 -O2 -I.. packer.cpp ../assetpack.cpp -o packer
+//
+//   packer OUTPUT FILE...     pack the files under their base names
+//   packer --list PACK        print a pack's index
+//
+// tools/pack-assets.sh builds this tool and packs every asset the game loads
+// into assets.pak; run it as part of building the game.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "assetpack.h"
+
+struct PackFile {
+    std::string name;
+    std::vector<char> bytes;
+    std::uint64_t offset = 0;
+};
+
+static void putU32(std::vector<char>& out, std::uint32_t value) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+}
+
+static void putU64(std::vector<char>& out, std::uint64_t value) {
+    for (int i = 0; i < 8; i++) out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+}
+
+static std::string baseName(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static std::uint64_t alignUp(std::uint64_t value) {
+    return (value + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+static int listPack(const char* path) {
+    AssetPack pack;
+    if (!pack.open(path)) {
+        std::fprintf(stderr, "%s is not a valid asset pack\n", path);
+        return 1;
+    }
+    for (std::uint32_t i = 0; i < pack.entryCount; i++) {
+        std::printf("%-32s %10llu\n", pack.entryName(i).c_str(), static_cast<unsigned long long>(pack.entrySize(i)));
+    }
+    std::printf("%u entries, %zu bytes\n", pack.entryCount, pack.size);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::strcmp(argv[1], "--list") == 0) {
+        return listPack(argv[2]);
+    }
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s OUTPUT FILE... | %s --list PACK\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    std::vector<PackFile> files;
+    for (int i = 2; i < argc; i++) {
+        PackFile file;
+        file.name = baseName(argv[i]);
+        if (file.name.size() >= static_cast<std::size_t>(ASSET_NAME_LENGTH)) {
+            std::fprintf(stderr, "%s: name longer than %d characters\n", argv[i], ASSET_NAME_LENGTH - 1);
+            return 1;
+        }
+        for (const PackFile& other : files) {
+            if (other.name == file.name) {
+                std::fprintf(stderr, "%s: duplicate name %s\n", argv[i], file.name.c_str());
+                return 1;
+            }
+        }
+        std::ifstream input(argv[i], std::ios::binary);
+        if (!input) {
+            std::fprintf(stderr, "Failed to read %s\n", argv[i]);
+            return 1;
+        }
+        file.bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        files.push_back(std::move(file));
+    }
+
+    std::uint64_t offset = alignUp(ASSET_PACK_HEADER_SIZE + files.size() * ASSET_PACK_ENTRY_SIZE);
+    for (PackFile& file : files) {
+        file.offset = offset;
+        offset = alignUp(offset + file.bytes.size());
+    }
+
+    std::vector<char> header;
+    header.insert(header.end(), { 'I', 'N', 'V', 'A' });
+    putU32(header, ASSET_PACK_VERSION);
+    putU32(header, static_cast<std::uint32_t>(files.size()));
+    putU32(header, 0);
+    for (const PackFile& file : files) {
+        char name[ASSET_NAME_LENGTH] = {};
+        std::memcpy(name, file.name.data(), file.name.size());
+        header.insert(header.end(), name, name + ASSET_NAME_LENGTH);
+        putU64(header, file.offset);
+        putU64(header, file.bytes.size());
+    }
+
+    std::ofstream output(argv[1], std::ios::binary | std::ios::trunc);
+    output.write(header.data(), header.size());
+    std::uint64_t written = header.size();
+    for (const PackFile& file : files) {
+        static const char padding[ASSET_PACK_ALIGNMENT] = {};
+        output.write(padding, file.offset - written);
+        output.write(file.bytes.data(), file.bytes.size());
+        written = file.offset + file.bytes.size();
+    }
+    if (!output) {
+        std::fprintf(stderr, "Failed to write %s\n", argv[1]);
+        return 1;
+    }
+
+    std::printf("Packed %zu files into %s (%llu bytes)\n", files.size(), argv[1], static_cast<unsigned long long>(written));
+    return 0;
+}
@@ -0,0 +1,337 @@
+// Headless multi-game runner for difficulty tuning. Plays N independent games,
+// each with its own seed and input source, on a work-stealing thread pool and
+// prints per-wave survival, clear times and throughput.
+//
+//   g++ -std=c++17 -O2 -DNDEBUG -pthread -I.. runner.cpp ../simulation.cpp
+//       ../formation.cpp ../collision.cpp ../profiler.cpp ../replay.cpp ../bunker.cpp
+//
+//   runner [--games N] [--seed S] [--threads T] [--policy bot|random|mixed]
+//          [--max-ticks N] [--replay FILE]...
+//
+// Every --replay adds one game that plays a recorded log with its own seed.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "replay.h"
+#include "rng.h"
+#include "simulation.h"
+
+enum Policy {
+    POLICY_BOT,
+    POLICY_RANDOM,
+    POLICY_REPLAY,
+};
+
+struct GameSpec {
+    std::uint64_t seed = 0;
+    Policy policy = POLICY_BOT;
+    std::string replayPath;
+};
+
+struct GameResult {
+    bool won = false;
+    bool valid = true;
+    int waveReached = 1;
+    long long ticks = 0;
+    long long clearTicks[FINAL_WAVE + 1] = {};
+    int livesLost[FINAL_WAVE + 1] = {};
+};
+
+// Stays under the nearest shooting column, sidesteps alien bolts coming down
+// on the ship and fires whenever it can.
+static InputFrame botInput(const Simulation& sim) {
+    InputFrame input;
+    input.fire = true;
+    input.firePressed = true;
+
+    float shipCenter = sim.ship.x + SHIP_SIZE / 2;
+    float target = shipCenter;
+    float nearest = sim.worldWidth;
+    const Formation& formation = sim.formation;
+    for (int i = 0; i < formation.shooterCount(); i++) {
+        float center = formation.x[formation.shooterSlot(i)] + ALIEN_SIZE / 2;
+        if (std::abs(center - shipCenter) < nearest) {
+            nearest = std::abs(center - shipCenter);
+            target = center;
+        }
+    }
+
+    sim.alienBolts.forEach([&](int, const Bolt& bolt) {
+        float center = bolt.x + BOLT_WIDTH / 2;
+        bool above = bolt.y + BOLT_HEIGHT > sim.ship.y - 150.0f && bolt.y < sim.ship.y + SHIP_SIZE;
+        if (above && std::abs(center - shipCenter) < SHIP_SIZE) {
+            target = center < shipCenter ? shipCenter + SHIP_SIZE : shipCenter - SHIP_SIZE;
+        }
+    });
+
+    input.moveLeft = target < shipCenter - 4.0f;
+    input.moveRight = target > shipCenter + 4.0f;
+    return input;
+}
+
+// Holds a random direction for half a second at a time and spends half of
+// those stretches tapping fire four times a second.
+static InputFrame randomInput(const Simulation& sim, Rng& rng, InputFrame& held) {
+    if (sim.clock.tick % (TICKS_PER_SECOND / 2) == 0) {
+        std::uint32_t roll = rng.below(3);
+        held.moveLeft = roll == 0;
+        held.moveRight = roll == 1;
+        held.fire = rng.below(2) == 0;
+    }
+    InputFrame input = held;
+    input.firePressed = held.fire && sim.clock.tick % (TICKS_PER_SECOND / 4) == 0;
+    return input;
+}
+
+static GameResult playGame(const GameSpec& spec, long long maxTicks) {
+    GameResult result;
+    InputReplay replay;
+    std::uint64_t seed = spec.seed;
+    if (spec.policy == POLICY_REPLAY) {
+        // Pixel masks come from the sprite sheets, which this tool does not
+        // load, so such replays would not play back the same.
+        if (!replay.open(spec.replayPath) || (replay.flags & REPLAY_PIXEL_MASKS)) {
+            result.valid = false;
+            return result;
+        }
+        seed = replay.seed;
+    }
+
+    Simulation sim(seed);
+    Rng rng(seed ^ 0x9e3779b97f4a7c15ULL);
+    InputFrame held;
+    std::uint32_t waveStart = 0;
+
+    while (result.ticks < maxTicks && sim.gameState != WINNER_STATE && sim.gameState != DEFEAT_STATE) {
+        InputFrame input;
+        if (spec.policy == POLICY_REPLAY) {
+            if (!replay.next(input)) break;
+        }
+        else if (sim.gameState != PLAY_STATE) {
+            input.start = true;
+        }
+        else if (spec.policy == POLICY_BOT) {
+            input = botInput(sim);
+        }
+        else {
+            input = randomInput(sim, rng, held);
+        }
+
+        int wave = sim.wave;
+        GameState state = sim.gameState;
+        sim.step(input, TICK_SECONDS);
+        result.ticks++;
+
+        // A wave starts on any way into play but un-pausing. Clear times use
+        // the simulation clock, which stands still while paused.
+        if (state != PLAY_STATE && state != PAUSE_STATE && sim.gameState == PLAY_STATE) {
+            waveStart = sim.clock.tick;
+        }
+        for (GameEvent event : sim.events) {
+            if (event == EVENT_SHIP_DAMAGED) result.livesLost[wave]++;
+        }
+        if (sim.wave != wave) {
+            result.clearTicks[wave] = sim.clock.since(waveStart);
+        }
+    }
+
+    result.won = sim.gameState == WINNER_STATE;
+    result.waveReached = sim.wave;
+    return result;
+}
+
+// Each worker owns a deque of game indices. It takes work from the back of
+// its own deque and, once that is empty, steals from the front of the others,
+// so long games on one core do not leave the rest idle.
+struct WorkStealingPool {
+    struct Queue {
+        std::mutex lock;
+        std::deque<int> tasks;
+    };
+
+    std::vector<Queue> queues;
+
+    explicit WorkStealingPool(int workers) : queues(workers) {}
+
+    void push(int worker, int task) {
+        queues[worker].tasks.push_back(task);
+    }
+
+    bool pop(int worker, int& task) {
+        Queue& own = queues[worker];
+        {
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < queues.size(); i++) {
+            Queue& victim = queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+struct WorkerStats {
+    long long games = 0;
+    long long stolen = 0;
+    long long ticks = 0;
+};
+
+// Clearing this wave wins the game. sim.wave only reads FINAL_WAVE on the
+// winner's screen, so this is the last wave that is played and has stats.
+const int LAST_WAVE = FINAL_WAVE - 1;
+
+static void report(const std::vector<GameSpec>& specs, const std::vector<GameResult>& results,
+                   const std::vector<WorkerStats>& workers, double seconds) {
+    long long reached[FINAL_WAVE + 1] = {};
+    long long cleared[FINAL_WAVE + 1] = {};
+    long long clearTicks[FINAL_WAVE + 1] = {};
+    long long livesLost[FINAL_WAVE + 1] = {};
+    long long totalTicks = 0;
+    int won = 0;
+    int invalid = 0;
+
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const GameResult& result = results[i];
+        if (!result.valid) {
+            std::fprintf(stderr, "Skipped replay %s: unreadable or recorded with pixel masks\n", specs[i].replayPath.c_str());
+            invalid++;
+            continue;
+        }
+        totalTicks += result.ticks;
+        if (result.won) won++;
+        for (int wave = 1; wave <= std::min(result.waveReached, LAST_WAVE); wave++) {
+            reached[wave]++;
+            livesLost[wave] += result.livesLost[wave];
+            if (wave < result.waveReached) {
+                cleared[wave]++;
+                clearTicks[wave] += result.clearTicks[wave];
+            }
+        }
+    }
+
+    int games = static_cast<int>(results.size()) - invalid;
+    std::printf("%5s %8s %8s %9s %10s %10s\n", "wave", "reached", "cleared", "survival", "clear s", "lost/game");
+    for (int wave = 1; wave <= LAST_WAVE; wave++) {
+        if (reached[wave] == 0) break;
+        std::printf("%5d %8lld %8lld %8.1f%% %10.2f %10.3f\n", wave, reached[wave], cleared[wave],
+            100.0 * cleared[wave] / reached[wave],
+            cleared[wave] ? static_cast<double>(clearTicks[wave]) / cleared[wave] / TICKS_PER_SECOND : 0.0,
+            static_cast<double>(livesLost[wave]) / reached[wave]);
+    }
+
+    std::printf("\n%d games, %d won (%.1f%%), %lld ticks in %.2f s\n", games, won,
+        games ? 100.0 * won / games : 0.0, totalTicks, seconds);
+    std::printf("%.0f ticks/s, %.1f games/s, %.0f ticks/s per thread over %zu threads\n",
+        totalTicks / seconds, games / seconds, totalTicks / seconds / workers.size(), workers.size());
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        std::printf("  thread %2zu: %5lld games (%lld stolen), %lld ticks\n", i, workers[i].games,
+            workers[i].stolen, workers[i].ticks);
+    }
+}
+
+int main(int argc, char** argv) {
+    int games = 1000;
+    std::uint64_t seed = 1;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    long long maxTicks = 60LL * 60 * TICKS_PER_SECOND;
+    const char* policy = "bot";
+    std::vector<std::string> replays;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            policy = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            maxTicks = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replays.push_back(argv[++i]);
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--games N] [--seed S] [--threads T] [--policy bot|random|mixed] "
+                "[--max-ticks N] [--replay FILE]...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (std::strcmp(policy, "bot") != 0 && std::strcmp(policy, "random") != 0 && std::strcmp(policy, "mixed") != 0) {
+        std::fprintf(stderr, "Unknown policy %s\n", policy);
+        return 1;
+    }
+    games = std::max(0, games);
+    threads = std::max(1, threads);
+
+    std::vector<GameSpec> specs;
+    Rng seeds(seed);
+    for (int i = 0; i < games; i++) {
+        GameSpec spec;
+        spec.seed = (static_cast<std::uint64_t>(seeds.next()) << 32) | seeds.next();
+        if (std::strcmp(policy, "random") == 0 || (std::strcmp(policy, "mixed") == 0 && i % 2 == 1)) {
+            spec.policy = POLICY_RANDOM;
+        }
+        specs.push_back(spec);
+    }
+    for (const std::string& path : replays) {
+        GameSpec spec;
+        spec.policy = POLICY_REPLAY;
+        spec.replayPath = path;
+        specs.push_back(spec);
+    }
+    if (specs.empty()) return 0;
+
+    WorkStealingPool pool(threads);
+    for (int i = 0; i < static_cast<int>(specs.size()); i++) {
+        pool.push(i % threads, i);
+    }
+
+    std::vector<GameResult> results(specs.size());
+    std::vector<WorkerStats> workers(threads);
+    std::vector<std::thread> workerThreads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int worker = 0; worker < threads; worker++) {
+        workerThreads.emplace_back([&, worker]() {
+            WorkerStats stats;
+            int task;
+            while (pool.pop(worker, task)) {
+                results[task] = playGame(specs[task], maxTicks);
+                stats.games++;
+                stats.ticks += results[task].ticks;
+                if (task % threads != worker) stats.stolen++;
+            }
+            workers[worker] = stats;
+        });
+    }
+    for (auto& thread : workerThreads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    report(specs, results, workers, seconds);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Converts telemetry logs written by the game to CSV on stdout.
+//
+//   g++ -std=c++17 -O2 -pthread -I.. teldecode.cpp ../telemetry.cpp -o teldecode
+//
+//   teldecode LOG...
+//
+// Pass rotated logs oldest first (telemetry.log.3 ... telemetry.log) to get
+// one continuous table. Times are nanoseconds since the session started;
+// unix_ns adds the session's wall-clock start.
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "telemetry.h"
+
+static const char* const stateNames[] = {
+    "beginning",
+    "play",
+    "pause",
+    "defeat",
+    "nextWave",
+    "winner",
+};
+
+static const char* stateName(int state) {
+    return state >= 0 && state <= WINNER_STATE ? stateNames[state] : "?";
+}
+
+// A readable form of the two values where they are not plain numbers.
+static void printDetail(const TelemetryRecord& record) {
+    if (record.type == TELEMETRY_STATE_CHANGE) {
+        std::printf("%s>%s", stateName(record.value0), stateName(record.value1));
+    }
+    else if (record.type == TELEMETRY_FRAME) {
+        std::printf("%s", stateName(record.value1));
+    }
+}
+
+static bool decode(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    TelemetryHeader header;
+    if (!readTelemetryHeader(file, header)) {
+        std::fprintf(stderr, "%s is not a telemetry log\n", path);
+        return false;
+    }
+    if (header.version != TELEMETRY_VERSION || header.recordSize != sizeof(TelemetryRecord)) {
+        std::fprintf(stderr, "%s: unsupported version %u\n", path, header.version);
+        return false;
+    }
+
+    std::vector<TelemetryRecord> records(4096);
+    for (;;) {
+        file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(TelemetryRecord));
+        std::size_t count = static_cast<std::size_t>(file.gcount()) / sizeof(TelemetryRecord);
+        for (std::size_t i = 0; i < count; i++) {
+            const TelemetryRecord& record = records[i];
+            std::printf("%llu,%llu,%llu,%u,%u,%s,%d,%d,", static_cast<unsigned long long>(header.seed),
+                static_cast<unsigned long long>(header.startUnixNanoseconds + record.time), static_cast<unsigned long long>(record.time),
+                record.tick, record.wave, telemetryTypeName(record.type), record.value0, record.value1);
+            printDetail(record);
+            std::printf("\n");
+        }
+        if (!file) break;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s LOG...\n", argv[0]);
+        return 1;
+    }
+    std::printf("seed,unix_ns,time_ns,tick,wave,event,value0,value1,detail\n");
+    for (int i = 1; i < argc; i++) {
+        if (!decode(argv[i])) return 1;
+    }
+    return 0;
+}
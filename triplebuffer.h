@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+
+// Single-producer, single-consumer triple buffer. The writer fills back() and
+// publish()es it; the reader acquire()s the newest published slot and reads
+// front() until its next acquire. Neither side ever waits: the three slots
+// change hands through one atomic exchange of the shared middle index, whose
+// FRESH bit tells the reader that something new is there.
+template <class T>
+struct TripleBuffer {
+    static const int FRESH = 4;
+
+    T slots[3];
+    std::atomic<int> middle{ 1 };
+    int backIndex = 0;
+    int frontIndex = 2;
+
+    T& back() {
+        return slots[backIndex];
+    }
+
+    void publish() {
+        backIndex = middle.exchange(backIndex | FRESH) & ~FRESH;
+    }
+
+    // Returns true when a newer slot was taken over.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        frontIndex = middle.exchange(frontIndex) & ~FRESH;
+        return true;
+    }
+
+    const T& front() const {
+        return slots[frontIndex];
+    }
+};
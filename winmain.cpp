@@ -1,657 +1,748 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <SFML/Audio.hpp>
+#include <iostream>
 #include <vector>
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
-
-enum GameState {
-    BEGINNING_STATE,
-    PLAY_STATE,
-    PAUSE_STATE,
-    DEFEAT_STATE,
-    NEXT_WAVE_STATE,
-    WINNER_STATE,
-};
-
-enum Direction {
-    Left,
-    Right,
-    Down
-};
-
-struct Ship {
-    sf::Sprite sprite;
-    bool isDying = false;
-    int currentFrame = 0; 
-    sf::Clock deathClock; 
-};
-
-struct Alien {
-    sf::Sprite sprite;
-    bool isDying = false;
-    int currentFrame = 0;
-    sf::Clock deathClock; 
-    sf::Clock movementClock;
-};
-
-struct AlienBolt {
-    sf::RectangleShape shape;
-    bool active = false;
+#include <string>
+#include "alloctrack.h"
+#include "capture.h"
+#include "hud.h"
+#include "input.h"
+#include "mixer.h"
+#include "profiler.h"
+#include "render.h"
+#include "replay.h"
+#include "resources.h"
+#include "savestate.h"
+#include "sfmlaudio.h"
+#include "simthread.h"
+#include "simulation.h"
+#include "telemetry.h"
+
+// Longest stretch of real time one frame may simulate; anything beyond it
+// is dropped instead of being caught up in a burst of ticks.
+const float MAX_FRAME_LAG = 0.25f;
+
+// How often a static screen is redrawn when the simulation runs on its own
+// thread and the window cannot simply wait for the next event.
+const int MENU_REDRAW_MS = 30;
+
+const char* const QUICKSAVE_PATH = "quicksave.bin";
+
+// Front-end keys that are not part of the recorded input. F2 toggles the
+// frame-rate readout; in practice mode F5 saves, F9 loads and holding R plays
+// the last few seconds backwards.
+struct Hotkeys {
+    bool stats = false;
+    bool save = false;
+    bool load = false;
+    bool rewind = false;
 };
 
-void beginState(sf::RenderWindow& window) {
-    sf::Font font;
-    if (!font.loadFromFile("Arcade.ttf")) {
-    
-    }
-
+void beginState(sf::RenderTarget& target, const sf::Font& font) {
     sf::Text text("Press 'S' to Start", font, 50);
 
     text.setFillColor(sf::Color::White);
     text.setPosition(200, 250);
-    window.clear();
-    window.draw(text);
-    window.display();
+    target.draw(text);
 
 }
 
-sf::Texture loadTexture(const std::string& filename) { 
-    sf::Texture texture; 
-    if (!texture.loadFromFile(filename)) { 
+void handleEvent(sf::RenderWindow& window, const sf::Event& event, InputState& input, Hotkeys* hotkeys) {
+    if (event.type == sf::Event::Closed)
+        window.close();
+
+    if (input.handle(event, InputState::Clock::now())) return;
+
+    if (hotkeys && event.type == sf::Event::LostFocus) {
+        hotkeys->rewind = false;
+    }
+    if (hotkeys && (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased) && event.key.code == sf::Keyboard::R) {
+        hotkeys->rewind = event.type == sf::Event::KeyPressed;
     }
-    return texture; 
-}
 
-std::vector<std::vector<Alien>> initializeAliens(sf::Texture& alienTexture, const std::vector<sf::IntRect>& movementFrames) {
-    std::vector<std::vector<Alien>> aliens; 
-    for (int i = 0; i < 3; i++) { 
-        std::vector<Alien> row; 
-        for (int j = 0; j < 10; j++) {  
-            sf::Sprite alienSprite(alienTexture); 
-            alienSprite.setPosition(100 + j * 60, i * 60 + 50); 
-            alienSprite.setTextureRect(movementFrames[0]); 
-            row.push_back({ alienSprite });  
+    if (event.type == sf::Event::KeyPressed) {
+        if (hotkeys && event.key.code == sf::Keyboard::F2) {
+            hotkeys->stats = true;
         }
-        aliens.push_back(row);
+        else if (hotkeys && event.key.code == sf::Keyboard::F5) {
+            hotkeys->save = true;
+        }
+        else if (hotkeys && event.key.code == sf::Keyboard::F9) {
+            hotkeys->load = true;
+        }
+#if INVADERS_PROFILE
+        else if (event.key.code == sf::Keyboard::F3) {
+            profiler().overlayVisible = !profiler().overlayVisible;
+        }
+#endif
     }
-    return aliens;
 }
 
-Ship initializeShip(sf::Texture& shipTexture) {
-    Ship ship;
-    ship.sprite.setTexture(shipTexture);
-    ship.sprite.setPosition(400, 500);
-    return ship;
-}
+// Drains the event queue into input. Called right before the ticks that use
+// it, so nothing sits in the queue for longer than it has to.
+void pollInput(sf::RenderWindow& window, InputState& input, Hotkeys* hotkeys) {
+    sf::Event event;
 
-void loadFrames(std::vector<sf::IntRect>& frames, int frameWidth, int frameHeight, int startX, int startY, int count, int columns) {
-    for (int i = 0; i < count; i++) {
-        int x = startX + (i % columns) * frameWidth;
-        int y = startY + (i / columns) * frameHeight;
-        frames.push_back(sf::IntRect(x, y, frameWidth, frameHeight));
-    } 
-}
-
-sf::RectangleShape initializeBarrier(sf::RenderWindow& window) {
-    sf::RectangleShape barrier(sf::Vector2f(window.getSize().x, 1));
-    barrier.setPosition(0, 5 * window.getSize().y / 7);
-    barrier.setFillColor(sf::Color::White);
-    return barrier;
-}
-
-void shipMovement(sf::RenderWindow& window, Ship& shipsprite, float time) {
-    float shipSpeed = 200.0f;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) {
-        shipsprite.sprite.move(0, -shipSpeed * time);
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) {
-        shipsprite.sprite.move(-shipSpeed * time, 0);
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
-        shipsprite.sprite.move(0, shipSpeed * time);
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) {
-        shipsprite.sprite.move(shipSpeed * time, 0);
-    }
-
-    if (shipsprite.sprite.getPosition().x < 0) {
-        shipsprite.sprite.setPosition(0, shipsprite.sprite.getPosition().y);
-    }
-    if (shipsprite.sprite.getPosition().x + shipsprite.sprite.getGlobalBounds().width > window.getSize().x) {
-        shipsprite.sprite.setPosition(window.getSize().x - shipsprite.sprite.getGlobalBounds().width, shipsprite.sprite.getPosition().y);
-    }
-    if (shipsprite.sprite.getPosition().y < 5 * window.getSize().y / 7) {
-        shipsprite.sprite.setPosition(shipsprite.sprite.getPosition().x, 5 * window.getSize().y / 7);
-    }
-    if (shipsprite.sprite.getPosition().y + shipsprite.sprite.getGlobalBounds().height > window.getSize().y) {
-        shipsprite.sprite.setPosition(shipsprite.sprite.getPosition().x, window.getSize().y - shipsprite.sprite.getGlobalBounds().height);
+    while (window.pollEvent(event))
+    {
+        handleEvent(window, event, input, hotkeys);
     }
-    window.draw(shipsprite.sprite);
 }
 
-void moveAliens(sf::RenderWindow& window, std::vector<std::vector<Alien>>& aliens, float& time, Direction& direction, bool& moveDown, std::vector<sf::IntRect>& movementFrames, std::vector<sf::IntRect>& deathFrames, float& alienSpeed, GameState& gamestate, sf::RectangleShape& barrier) {
-    bool changeDirection = false;
-    for (auto& row : aliens) {
-        for (auto& alien : row) {
-            if (alien.isDying) continue;
-            if (alien.movementClock.getElapsedTime().asSeconds() > 0.5f) {
-                alien.currentFrame = (alien.currentFrame + 1) % movementFrames.size(); 
-                alien.sprite.setTextureRect(movementFrames[alien.currentFrame]);
-                alien.movementClock.restart();
-            }
-            if (direction == Right) {
-                alien.sprite.move(alienSpeed * time, 0);
-                if (alien.sprite.getPosition().x + alien.sprite.getGlobalBounds().width > window.getSize().x) {
-                    changeDirection = true;
-                }
-            }
-            else if (direction == Left) {
-                alien.sprite.move(-alienSpeed * time, 0);
-                if (alien.sprite.getPosition().x < 0) {
-                    changeDirection = true;
-                }
-            }
-            if (alien.sprite.getPosition().y + alien.sprite.getGlobalBounds().height >= barrier.getPosition().y) {
-                gamestate = DEFEAT_STATE;
-            }
-        }
-    }
+// Sleeps until the window receives an event, then drains the queue. Used on
+// the static screens so an idle game does not spin.
+void waitInput(sf::RenderWindow& window, InputState& input, Hotkeys* hotkeys) {
+    sf::Event event;
 
-    if (changeDirection) { 
-        direction = (direction == Right) ? Left : Right;
-        moveDown = true;
+    if (window.waitEvent(event)) {
+        handleEvent(window, event, input, hotkeys);
     }
+    pollInput(window, input, hotkeys);
+}
 
-    if (moveDown) {
-        for (auto& row : aliens) {
-            for (auto& alien : row) {
-                alien.sprite.move(0, 20);
-            }
-        }
-        moveDown = false;
-    }
+#if INVADERS_PROFILE
+void drawProfilerOverlay(sf::RenderTarget& target, const sf::Font& font) {
+    const Profiler& prof = profiler();
+    std::string lines = "section  p50 / p99 / max (us)\n";
+    char line[96];
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        const RollingHistogram& histogram = prof.histograms[i];
+        std::snprintf(line, sizeof(line), "%s  %.1f / %.1f / %.1f\n", profileSectionName(i),
+            histogram.percentile(0.5f) / 1000.0f, histogram.percentile(0.99f) / 1000.0f, histogram.max() / 1000.0f);
+        lines += line;
+    }
+
+    sf::Text text(lines, font, 14);
+    text.setFillColor(sf::Color::Green);
+    text.setPosition(20, 60);
+    target.draw(text);
 }
+#endif
 
-void fireBolt(sf::RenderWindow& window, Ship& shipsprite, std::vector<sf::RectangleShape>& bolts, sf::Clock& fire, float& boltSpeed, float& time, sf::Sound& boltNoise) {
-    if (shipsprite.isDying) return;
-    
-    static bool isSpacePressed = false; 
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) { 
-        if (!isSpacePressed && bolts.size() < 3 && fire.getElapsedTime().asSeconds() >= 0.5f) { 
-            sf::RectangleShape bolt(sf::Vector2f(8, 30)); 
-            bolt.setFillColor(sf::Color::Blue); 
-            bolt.setPosition(shipsprite.sprite.getPosition().x + shipsprite.sprite.getGlobalBounds().width / 2 - bolt.getSize().x / 2, shipsprite.sprite.getPosition().y);
-            bolts.push_back(bolt); 
-            boltNoise.play();
-            isSpacePressed = true; 
-            fire.restart(); 
-        }
-        else {
-            isSpacePressed = false; 
-        }
+void playState(sf::RenderTarget& target, const Simulation& previous, const Simulation& sim, float alpha, const sf::Font& font, Hud& hud, PlayRenderer& renderer) {
+    {
+        PROFILE_SCOPE(PROFILE_HUD);
+        hud.update(sim);
     }
 
-    for (auto& bolt : bolts) {
-        bolt.move(0, -boltSpeed * time);
-    }
+    {
+        PROFILE_SCOPE(PROFILE_RENDER);
+        renderer.build(previous, sim, alpha);
 
-    for (const auto& bolt : bolts) {
-        window.draw(bolt);
+        target.clear();  
+        hud.draw(target);
+        renderer.draw(target);
     }
-}
 
-bool areAliensRemaining(const std::vector<std::vector<Alien>>& aliens) {
-    for (const auto& row : aliens) {
-        if (!row.empty()) {
-            return true;
-        }
+#if INVADERS_PROFILE
+    if (profiler().overlayVisible) {
+        drawProfilerOverlay(target, font);
     }
-    return false;
+#else
+    (void)font;
+#endif
 }
 
-void alienBoltCollisons(sf::RenderWindow& window, std::vector<std::vector<Alien>>& aliens, std::vector<sf::RectangleShape>& bolts, std::vector<sf::IntRect>& deathFrames,sf::Sound& alienDestroyedSound) {
-    for (auto& bolt : bolts) {
-        for (auto& row : aliens) {
-            for (auto& alien : row) {
-                if (!alien.isDying && bolt.getGlobalBounds().intersects(alien.sprite.getGlobalBounds())) {
-                    bolt.setPosition(-100, -100);
-                    alien.isDying = true;
-                    alienDestroyedSound.play();
-                    alien.currentFrame = 0;
-                    alien.sprite.setTextureRect(deathFrames[0]);
-                    alien.deathClock.restart();
-                }
-            }
-        }
-    }
+void pauseState(sf::RenderTarget& target, const sf::Font& font) {
+    sf::Text text("Game Paused", font, 50);
+    sf::Text text1("Press 'P' to Resume", font, 50);
 
-    for (auto& row : aliens) {
-        for (auto& alien : row) {
-            if (alien.isDying) {
-                if (alien.deathClock.getElapsedTime().asSeconds() > 0.05f) {
-                    alien.currentFrame++;
+    text.setFillColor(sf::Color::White);
+    text.setPosition(190, 200);
+    text1.setFillColor(sf::Color::White);
+    text1.setPosition(75, 250);
+    target.draw(text);
+    target.draw(text1);
+}
 
-                    if (alien.currentFrame < deathFrames.size()) {
-                        alien.sprite.setTextureRect(deathFrames[alien.currentFrame]);
-                    }
-                    else {
-                        alien.sprite.setPosition(-100, -100);
-                    }
-                    alien.deathClock.restart();
-                }
-            }
-            window.draw(alien.sprite);
+void winnerState(sf::RenderTarget& target, const sf::Font& font) { 
+    sf::Text text("You Won!", font, 50);
+    sf::Text text1("Press 'S' to Restart", font, 50);
 
+    text.setFillColor(sf::Color::White);
+    text.setPosition(260, 200);
+    text1.setFillColor(sf::Color::White);
+    text1.setPosition(50, 250);
+    target.draw(text);
+    target.draw(text1);
 
-        }
-    }
+}
 
-    bolts.erase(std::remove_if(bolts.begin(), bolts.end(), [](const sf::RectangleShape& bolt) {
-        return bolt.getPosition().y + bolt.getSize().y < 0 || bolt.getPosition().x == -100;
-        }), bolts.end());
+void defeatState(sf::RenderTarget& target, const sf::Font& font) {
+    sf::Text text("You Lost!", font, 50);
+    sf::Text text1("Press 'S' to Restart", font ,50);
 
-    for (auto& row : aliens) {
-        row.erase(std::remove_if(row.begin(), row.end(), [](const Alien& alien) {
-            return alien.sprite.getPosition().x == -100;
-            }), row.end());
-    }
+    text.setFillColor(sf::Color::White);
+    text.setPosition(230, 200);
+    text1.setFillColor(sf::Color::White);
+    text1.setPosition(50, 250);
+    target.draw(text); 
+    target.draw(text1);
+    
 }
 
-void alienShootBolts(sf::RenderWindow& window, std::vector<std::vector<Alien>>& aliens, sf::Clock alienFireClock, AlienBolt& alienBolt, float time, float& alienBoltSpeed) {
+void nextWaveState(sf::RenderTarget& target, const sf::Font& font) {
+    sf::Text text("Wave Complete", font ,50); 
+    sf::Text text1("Press 'S' to Continue", font, 50);
 
-    if (!alienBolt.active && alienFireClock.getElapsedTime().asSeconds() >= 6.0f) {
-        std::vector<Alien*> activeAliens;
-        for (auto& row : aliens) {
-            for (auto& alien : row) {
-                if (!alien.isDying) {
-                    activeAliens.push_back(&alien);
-                }
-            }
-        }
+    text.setFillColor(sf::Color::White);
+    text.setPosition(150, 200);
+    text1.setFillColor(sf::Color::White);
+    text1.setPosition(30, 250);
+    target.draw(text);
+    target.draw(text1);
+}
 
-        if (!activeAliens.empty()) {
-            Alien* shootingAlien = activeAliens[rand() % activeAliens.size()];
-            alienBolt.shape.setPosition(shootingAlien->sprite.getPosition().x + shootingAlien->sprite.getGlobalBounds().width / 2, shootingAlien->sprite.getPosition().y + shootingAlien->sprite.getGlobalBounds().height);
-            alienBolt.active = true;
-            alienFireClock.restart();
-        }
-    }
+// The static screens are drawn once into a texture when their state is
+// entered; after that each redraw is a single sprite.
+struct MenuScreen {
+    sf::RenderTexture texture;
+    bool cached = false;
+    bool available = false;
+    GameState state = BEGINNING_STATE;
+};
 
-    if (alienBolt.active) {
-        alienBolt.shape.move(0, alienBoltSpeed * time);
-        if (alienBolt.shape.getPosition().y > window.getSize().y) {
-            alienBolt.active = false;
-            alienBolt.shape.setPosition(-100, -100);
-        }
-        window.draw(alienBolt.shape);
+void drawMenuState(sf::RenderTarget& target, GameState state, const Resources& resources) {
+    const sf::Font& menuFont = getFont(resources, FONT_RETRO_GAME);
+
+    switch (state) {
+        case BEGINNING_STATE:
+            beginState(target, getFont(resources, FONT_ARCADE));
+            break;
+        case PAUSE_STATE:
+            pauseState(target, menuFont);
+            break;
+        case NEXT_WAVE_STATE:
+            nextWaveState(target, menuFont);
+            break;
+        case WINNER_STATE:
+            winnerState(target, menuFont);
+            break;
+        case DEFEAT_STATE:
+            defeatState(target, menuFont);
+            break;
+        case PLAY_STATE:
+            break;
     }
 }
 
-void shipBoltCollisions(AlienBolt& alienBolt, Ship& ship, int& lives, GameState& gameState, const std::vector<sf::IntRect>& shipDeathFrames, sf::Sound& shipDamage) {
-    if (alienBolt.active && alienBolt.shape.getGlobalBounds().intersects(ship.sprite.getGlobalBounds()) && !ship.isDying) {
-        lives--;
-        alienBolt.active = false;
-        shipDamage.play();
-        alienBolt.shape.setPosition(-100, -100);
-        if (lives <= 0) {
-            ship.isDying = true;
-        }
-        ship.currentFrame = 0;
-        ship.sprite.setTextureRect(shipDeathFrames[0]);
-        ship.deathClock.restart();
+void menuState(sf::RenderTarget& target, MenuScreen& menu, const Simulation& sim, const Resources& resources) {
+    target.clear();
+    if (!menu.available) {
+        drawMenuState(target, sim.gameState, resources);
+        return;
     }
-}
 
-void boltCollisions(std::vector<sf::RectangleShape>& bolts, AlienBolt& alienBolt, sf::Sound& boltDestroyedSound) {
-    if (alienBolt.active) {
-        bolts.erase(std::remove_if(bolts.begin(), bolts.end(), [&alienBolt, &boltDestroyedSound](const sf::RectangleShape& bolt) {
-            if (bolt.getGlobalBounds().intersects(alienBolt.shape.getGlobalBounds())) {
-                alienBolt.active = false;
-                boltDestroyedSound.play();
-                alienBolt.shape.setPosition(-100, -100);
-                return true;
-            }
-            return false;
-            }), bolts.end());
+    if (!menu.cached || menu.state != sim.gameState) {
+        menu.texture.clear();
+        drawMenuState(menu.texture, sim.gameState, resources);
+        menu.texture.display();
+        menu.cached = true;
+        menu.state = sim.gameState;
     }
-}  
 
-bool isShipDeathAnimationDone(const Ship& ship, const std::vector<sf::IntRect>& deathFrames) {
-    return ship.currentFrame >= deathFrames.size();
+    target.draw(sf::Sprite(menu.texture.getTexture()));
 }
 
-
-void shipDeathAnimation(sf::RenderWindow& window, Ship& ship, const std::vector<sf::IntRect>& deathFrames) {
-    if (ship.isDying) {
-        if (ship.deathClock.getElapsedTime().asSeconds() > 0.3f) {
-            ship.currentFrame++;
-            if (ship.currentFrame < deathFrames.size()) {
-                ship.sprite.setTextureRect(deathFrames[ship.currentFrame]);
-            }
-            else {
-                ship.sprite.setPosition(-100, -100); 
-            }
-            ship.deathClock.restart();
-        }
-        window.draw(ship.sprite);
+// Shows the frame drawn into frameTarget(). A captured frame was drawn
+// offscreen; it is handed to the capture and then copied to the window.
+void presentFrame(sf::RenderWindow& window, FrameCapture* capture) {
+    if (capture) {
+        capture->target.display();
+        capture->grab();
+        window.draw(sf::Sprite(capture->target.getTexture()));
     }
-}
-
-void handleBarrierCollisions(sf::RectangleShape& barrier, std::vector<sf::RectangleShape>& bolts, AlienBolt& alienBolt) {
-    bolts.erase(std::remove_if(bolts.begin(), bolts.end(), [&barrier](const sf::RectangleShape& bolt) {
-        return bolt.getGlobalBounds().intersects(barrier.getGlobalBounds());
-        }), bolts.end());
 
-    if (alienBolt.shape.getGlobalBounds().intersects(barrier.getGlobalBounds())) {
-        alienBolt.active = false;
-        alienBolt.shape.setPosition(-100, -100);
-    }
+    PROFILE_SCOPE(PROFILE_DISPLAY);
+    window.display();
 }
 
-void playState(sf::RenderWindow& window, std::vector<std::vector<Alien>>& aliens, Ship& shipsprite,float time, std::vector<sf::RectangleShape>& bolts,sf::Clock& fire, Direction& direction,bool& moveDown, std::vector<sf::IntRect>& movementFrames, std::vector<sf::IntRect>& deathFrames, sf::Texture& alienTexture, int& lives, GameState& gamestate, sf::Clock alienFire, AlienBolt& alienBolt, const std::vector<sf::IntRect>& shipDeathFrames, float& alienSpeed, float& alienBoltSpeed, int& wave, sf::RectangleShape& barrier, sf::Sound& shipBoltNoise, sf::Sound& alienDestoryedSound, sf::Sound& boltDestoryedSound, sf::Sound& shipDamage) {
-    
-    float shipSpeed = 200.0f;
-    float boltSpeed = 300.0f;
+sf::RenderTarget& frameTarget(sf::RenderWindow& window, FrameCapture* capture) {
+    if (capture) return capture->target;
+    return window;
+}
 
-    sf::Font font;
-    if (!font.loadFromFile("ComicSans.ttf")) { 
+// Frames played before --alloc-check starts failing PLAY_STATE frames that
+// allocate; the first ones still fill pools, vectors and driver caches.
+const std::uint64_t ALLOC_WARMUP_FRAMES = 120;
 
+const char* gameStateName(int state) {
+    switch (state) {
+        case BEGINNING_STATE: return "begin";
+        case PLAY_STATE: return "play";
+        case PAUSE_STATE: return "pause";
+        case DEFEAT_STATE: return "defeat";
+        case NEXT_WAVE_STATE: return "next wave";
+        case WINNER_STATE: return "winner";
     }
+    return "?";
+}
 
-    sf::Text text("Lives: " + std::to_string(lives), font, 20);
-    sf::Text waveText("Wave: " + std::to_string(wave), font, 20);
+// Per-state allocation counts for the window thread. A frame counts as played
+// only if it started and ended in PLAY_STATE, so wave and menu transitions do
+// not trip the check. The profiler overlay formats text and is exempt.
+struct AllocationCheck {
+    AllocationStats stats;
+    bool enforce = false;
+    std::uint64_t violations = 0;
+
+    void endFrame(GameState before, GameState after) {
+        std::uint64_t count = stats.endFrame(after);
+        bool played = before == PLAY_STATE && after == PLAY_STATE && stats.frames[PLAY_STATE] > ALLOC_WARMUP_FRAMES;
+#if INVADERS_PROFILE
+        played = played && !profiler().overlayVisible;
+#endif
+        if (enforce && played && count > 0) {
+            if (violations == 0) {
+                std::cerr << "Allocation check: " << count << " allocation(s) in play frame " << stats.frames[PLAY_STATE] << std::endl;
+            }
+            violations++;
+        }
+    }
 
-    waveText.setFillColor(sf::Color::Yellow);
-    waveText.setPosition(20, 20);
+    void print() const {
+        std::cerr << "state       frames     allocs  per frame      worst" << std::endl;
+        for (int state = 0; state < ALLOC_TRACK_STATES; state++) {
+            if (stats.frames[state] == 0) continue;
+            char line[96];
+            std::snprintf(line, sizeof(line), "%-9s %8llu %10llu %10.3f %10llu", gameStateName(state),
+                static_cast<unsigned long long>(stats.frames[state]), static_cast<unsigned long long>(stats.total[state]),
+                static_cast<double>(stats.total[state]) / stats.frames[state], static_cast<unsigned long long>(stats.worst[state]));
+            std::cerr << line << std::endl;
+        }
+        if (enforce) {
+            std::cerr << "Allocation check " << (violations ? "FAILED: " : "passed: ") << violations << " play frame(s) allocated" << std::endl;
+        }
+    }
+};
 
-    text.setFillColor(sf::Color::Yellow); 
-    text.setPosition(700, 20);  
-    window.clear();  
-    window.draw(waveText);
-    window.draw(barrier);
-    window.draw(text); 
+// The window side of --threaded: pump events, forward input and draw the
+// newest snapshot. Static screens redraw at a low rate instead of blocking,
+// because a state change now arrives from the other thread, not an event.
+void threadedLoop(sf::RenderWindow& window, SimulationThread& simThread, InputState& input, const Resources& resources, Hud& hud, PlayRenderer& renderer, MenuScreen& menu, AllocationCheck& allocations, LatencyStats* latency, FrameCapture* capture, Telemetry* telemetry) {
+    simThread.start();
+
+    GameState state = simThread.snapshots.front().current.gameState;
+    Hotkeys hotkeys;
+    sf::Clock frameClock;
+    // Input counts as taken once a snapshot published after it was handed
+    // over reaches the screen.
+    bool submitted = false;
+    std::chrono::steady_clock::time_point changeTime;
+    std::chrono::steady_clock::time_point submitTime;
+    // The simulation thread's section totals as of the last merge.
+    std::uint64_t profileSeen[PROFILE_SECTION_COUNT] = {};
+    while (window.isOpen())
+    {
+        GameState frameState = state;
+        pollInput(window, input, &hotkeys);
+        InputFrame presses = input.takePresses();
+        simThread.submit(input.heldFrame(), presses);
+        if (!submitted && input.takeChange(changeTime)) {
+            submitted = true;
+            submitTime = std::chrono::steady_clock::now();
+        }
+        if (hotkeys.stats) {
+            hotkeys.stats = false;
+            hud.toggleStats();
+        }
+        float frameSeconds = frameClock.restart().asSeconds();
+        hud.frameTime(frameSeconds);
+        if (simThread.finished) {
+            window.close();
+            break;
+        }
 
-    moveAliens(window, aliens, time, direction, moveDown, movementFrames, deathFrames, alienSpeed, gamestate, barrier); 
+        simThread.snapshots.acquire();
+        const SimSnapshot& snapshot = simThread.snapshots.front();
+        PROFILE_MERGE(snapshot.profileTotals, profileSeen);
+        if (telemetry) telemetry->recordFrame(frameSeconds, snapshot.current);
+        if (submitted && snapshot.time >= submitTime) {
+            submitted = false;
+            if (latency) latency->taken(changeTime);
+        }
 
-    alienBoltCollisons(window, aliens, bolts, deathFrames, alienDestoryedSound);
+        sf::RenderTarget& target = frameTarget(window, capture);
+        bool playing = snapshot.current.gameState == PLAY_STATE;
+        if (playing) {
+            float alpha = std::chrono::duration<float>(std::chrono::steady_clock::now() - snapshot.time).count() / TICK_SECONDS;
+            playState(target, snapshot.previous, snapshot.current, std::min(alpha, 1.0f), getFont(resources, FONT_COMIC_SANS), hud, renderer);
+        }
+        else {
+            menuState(target, menu, snapshot.current, resources);
+        }
+        presentFrame(window, capture);
+        if (latency) latency->presented(std::chrono::steady_clock::now());
+        if (!playing) {
+            sf::sleep(sf::milliseconds(MENU_REDRAW_MS));
+        }
 
-    alienShootBolts(window, aliens, alienFire, alienBolt, time, alienBoltSpeed);
-    
-    shipBoltCollisions(alienBolt, shipsprite, lives, gamestate, shipDeathFrames, shipDamage);
+        PROFILE_END_FRAME();
+        state = snapshot.current.gameState;
+        allocations.endFrame(frameState, state);
+    }
 
-    boltCollisions(bolts, alienBolt, boltDestoryedSound);
+    simThread.stop();
+}
 
-    shipDeathAnimation(window, shipsprite, shipDeathFrames);
+// Rate of a headless capture; every other tick becomes a frame.
+const int CAPTURE_FRAMES_PER_SECOND = 60;
+
+// --replay with --fast and --capture: no window. Replayed ticks that land on
+// the capture rate are drawn offscreen and captured; nothing has to keep up
+// with real time, so the capture waits for the encoder instead of dropping.
+int captureReplay(InputReplay& replay, const SpriteMasks* masks, Resources& resources, const char* capturePath) {
+    FrameCapture capture;
+    if (!capture.start(capturePath, static_cast<unsigned>(WORLD_WIDTH), static_cast<unsigned>(WORLD_HEIGHT), CAPTURE_FRAMES_PER_SECOND)) {
+        std::cerr << "Failed to start capture to " << capturePath << std::endl;
+        return 1;
+    }
+    if (!loadResources(resources)) {
+        for (const auto& file : resources.failures) {
+            std::cerr << "Failed to load " << file << std::endl;
+        }
+    }
+    PlayRenderer renderer(resources);
+    Hud hud(getFont(resources, FONT_COMIC_SANS));
+    MenuScreen menu;
 
-    fireBolt(window, shipsprite, bolts, fire, boltSpeed, time, shipBoltNoise);
-    
-    shipMovement(window, shipsprite, time);
+    Simulation sim(replay.seed);
+    sim.masks = (replay.flags & REPLAY_PIXEL_MASKS) ? masks : nullptr;
+    InputFrame input;
+    std::uint64_t ticks = 0;
+    while (replay.next(input)) {
+        sim.step(input, TICK_SECONDS);
+        if (++ticks % (TICKS_PER_SECOND / CAPTURE_FRAMES_PER_SECOND) != 0) continue;
 
-    if (shipsprite.isDying && isShipDeathAnimationDone(shipsprite, shipDeathFrames)) {
-        if (lives <= 0) {
-            gamestate = DEFEAT_STATE;
+        if (sim.gameState == PLAY_STATE) {
+            playState(capture.target, sim, sim, 1.0f, getFont(resources, FONT_COMIC_SANS), hud, renderer);
         }
         else {
-            shipsprite.isDying = false;
-            shipsprite.sprite.setPosition(400, 500);
+            menuState(capture.target, menu, sim, resources);
         }
+        capture.target.display();
+        capture.grab(true);
     }
+    capture.stop();
+    capture.report();
 
-    window.display();
+    bool match = replay.finished() && hashSimulation(sim) == replay.finalHash;
+    std::cout << "Replay " << (match ? "matches" : "does NOT match") << " the recording" << std::endl;
+    return match ? 0 : 2;
 }
 
-void pauseState(sf::RenderWindow& window) {
-    sf::Font font;
-    if (!font.loadFromFile("RetroGame.ttf")) {
+int main(int argc, char** argv)
+{
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    bool fast = false;
+    int frameLimit = 60;
+    bool vsync = false;
+    bool threaded = false;
+    bool allocCheck = false;
+    float rewindSeconds = 10.0f;
+    float rewindMegabytes = 4.0f;
+    bool measureLatency = false;
+    const char* capturePath = nullptr;
+    const char* telemetryPath = nullptr;
+    InputState input;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--fast") {
+            fast = true;
+        }
+        else if (arg == "--fps" && i + 1 < argc) {
+            frameLimit = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--vsync") {
+            vsync = true;
+        }
+        else if (arg == "--threaded") {
+            threaded = true;
+        }
+        else if (arg == "--alloc-check") {
+            allocCheck = true;
+        }
+        else if (arg == "--rewind-seconds" && i + 1 < argc) {
+            rewindSeconds = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        }
+        else if (arg == "--rewind-mb" && i + 1 < argc) {
+            rewindMegabytes = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        }
+        else if (arg == "--bind" && i + 1 < argc && input.bindings.bind(argv[i + 1])) {
+            i++;
+        }
+        else if (arg == "--latency") {
+            measureLatency = true;
+        }
+        else if (arg == "--capture" && i + 1 < argc) {
+            capturePath = argv[++i];
+        }
+        else if (arg == "--telemetry" && i + 1 < argc) {
+            telemetryPath = argv[++i];
+        }
+        else {
+            std::cerr << "usage: " << argv[0] << " [--record FILE] [--replay FILE [--fast]] [--fps N (0 = unlimited)] [--vsync] [--threaded] [--alloc-check] [--rewind-seconds S] [--rewind-mb MB] [--bind ACTION=KEY[,KEY]] [--latency] [--capture PREFIX|FILE.y4m] [--telemetry FILE]" << std::endl;
+            return 1;
+        }
+    }
 
+    InputReplay replay;
+    if (replayPath && !replay.open(replayPath)) {
+        std::cerr << "Failed to read replay " << replayPath << std::endl;
+        return 1;
     }
 
-    sf::Text text("Game Paused", font, 50);
-    sf::Text text1("Press 'P' to Resume", font, 50);
+    // Assets live next to the executable, so the game starts from any
+    // working directory. Mapping the pack needs no window yet.
+    Resources resources;
+    openAssets(resources, executableDirectory(argv[0]));
 
-    text.setFillColor(sf::Color::White);
-    text.setPosition(190, 200);
-    text1.setFillColor(sf::Color::White);
-    text1.setPosition(75, 250);
-    window.clear();
-    window.draw(text);
-    window.draw(text1);
-    window.display();
-}
+    SpriteMasks masks;
+    bool useMasks = loadSpriteMasks(masks, resources);
+    if (!useMasks) {
+        std::cerr << "Failed to build collision masks; using rectangles" << std::endl;
+    }
+    if (replayPath) {
+        if ((replay.flags & REPLAY_PIXEL_MASKS) && !useMasks) {
+            std::cerr << "Replay " << replayPath << " needs collision masks" << std::endl;
+            return 1;
+        }
+        useMasks = (replay.flags & REPLAY_PIXEL_MASKS) != 0;
+    }
+    if (replayPath && fast && capturePath) {
+        return captureReplay(replay, useMasks ? &masks : nullptr, resources, capturePath);
+    }
+    if (replayPath && fast) {
+        return fastForwardReplay(replay, useMasks ? &masks : nullptr);
+    }
 
-void winnerState(sf::RenderWindow& window) { 
-    sf::Font font;
-    if (!font.loadFromFile("RetroGame.ttf")) {
+    std::uint64_t seed = replayPath ? replay.seed : static_cast<std::uint64_t>(time(0));
+    InputRecorder recorder;
+    if (recordPath && !recorder.open(recordPath, seed, useMasks ? REPLAY_PIXEL_MASKS : 0)) {
+        std::cerr << "Failed to create replay " << recordPath << std::endl;
+    }
 
+    sf::RenderWindow window(sf::VideoMode(800, 600), "Alien Invaders");
+    // The simulation runs at its own fixed rate, so the render rate only
+    // changes smoothness, never gameplay.
+    window.setVerticalSyncEnabled(vsync);
+    window.setFramerateLimit(vsync ? 0 : frameLimit);
+
+    if (!loadResources(resources)) {
+        for (const auto& file : resources.failures) {
+            std::cerr << "Failed to load " << file << std::endl;
+        }
     }
 
-    sf::Text text("You Won!", font, 50);
-    sf::Text text1("Press 'S' to Restart", font, 50);
+    PlayRenderer renderer(resources);
+    Hud hud(getFont(resources, FONT_COMIC_SANS));
 
-    text.setFillColor(sf::Color::White);
-    text.setPosition(260, 200);
-    text1.setFillColor(sf::Color::White);
-    text1.setPosition(50, 250);
-    window.clear();
-    window.draw(text);
-    window.draw(text1);
-    window.display();
+    Simulation sim(seed);
+    sim.masks = useMasks ? &masks : nullptr;
+    Simulation previous(seed);
 
-}
+    SfmlAudioBackend audio;
+    Mixer mixer(audio);
+    loadSoundEffects(mixer, audio, resources);
 
-void defeatState(sf::RenderWindow& window) {
-    sf::Font font;
-    if (!font.loadFromFile("RetroGame.ttf")) {
+    MenuScreen menu;
+    menu.available = menu.texture.create(window.getSize().x, window.getSize().y);
 
+#if !INVADERS_TRACK_ALLOCS
+    if (allocCheck) {
+        std::cerr << "--alloc-check needs a build with INVADERS_TRACK_ALLOCS" << std::endl;
+        return 1;
     }
+#endif
+    AllocationCheck allocations;
+    allocations.enforce = allocCheck;
+    // Replayed ticks do not come from the keyboard, so there is nothing to time.
+    LatencyStats latency;
+    LatencyStats* latencyStats = measureLatency && !replayPath ? &latency : nullptr;
 
-    sf::Text text("You Lost!", font, 50);
-    sf::Text text1("Press 'S' to Restart", font ,50);
-
-    text.setFillColor(sf::Color::White);
-    text.setPosition(230, 200);
-    text1.setFillColor(sf::Color::White);
-    text1.setPosition(50, 250);
-    window.clear();
-    window.draw(text); 
-    window.draw(text1);
-    window.display(); 
-    
-}
-
-void nextWaveState(sf::RenderWindow& window, int& wave) {
-    sf::Font font;
-    if (!font.loadFromFile("RetroGame.ttf")) {
+    FrameCapture frameCapture;
+    FrameCapture* capture = nullptr;
+    if (capturePath) {
+        int rate = vsync || frameLimit == 0 ? CAPTURE_FRAMES_PER_SECOND : frameLimit;
+        if (frameCapture.start(capturePath, window.getSize().x, window.getSize().y, rate)) {
+            capture = &frameCapture;
+        }
+        else {
+            std::cerr << "Failed to start capture to " << capturePath << std::endl;
+        }
+    }
 
+    // Only written when asked for; the game plays on without it if the log
+    // cannot be written.
+    Telemetry sessionTelemetry;
+    Telemetry* telemetry = nullptr;
+    if (telemetryPath) {
+        if (sessionTelemetry.start(telemetryPath, seed)) {
+            telemetry = &sessionTelemetry;
+            telemetry->sync(sim);
+        }
+        else {
+            std::cerr << "Failed to open telemetry log " << telemetryPath << std::endl;
+        }
     }
-    sf::Text text("Wave Complete", font ,50); 
-    sf::Text text1("Press 'S' to Continue", font, 50);
 
-    text.setFillColor(sf::Color::White);
-    text.setPosition(150, 200);
-    text1.setFillColor(sf::Color::White);
-    text1.setPosition(30, 250);
-    window.clear();
-    window.draw(text);
-    window.draw(text1);
-    window.display();
-}
+    if (threaded) {
+        SimulationThread simThread(sim, mixer, recorder.isOpen() ? &recorder : nullptr, replayPath ? &replay : nullptr);
+        simThread.telemetry = telemetry;
+        threadedLoop(window, simThread, input, resources, hud, renderer, menu, allocations, latencyStats, capture, telemetry);
+        sim = simThread.sim;
+    }
 
-int main()
-{
-    sf::RenderWindow window(sf::VideoMode(800, 600), "Alien Invaders");
-    window.setFramerateLimit(60);
+    // Save states and rewind would fork a recording or a replay away from its
+    // input log, so they are only offered in plain play.
+    bool practice = !recordPath && !replayPath;
+    Hotkeys hotkeys;
+    RewindBuffer rewind(practice ? static_cast<std::size_t>(rewindMegabytes * 1024 * 1024) : 0,
+        practice ? std::max(1, static_cast<int>(secondsToTicks(rewindSeconds))) : 1);
+    GameSnapshot snapshot;
 
-    GameState gameState = BEGINNING_STATE; 
+    sf::Clock clock;
+    float lag = 0.0f;
+    InputState::Clock::time_point changeTime;
 
+    while (window.isOpen())
+    {
+        GameState frameState = sim.gameState;
+        // The frame limiter and vsync wait inside display(), so this is the
+        // latest point before the ticks run.
+        if (sim.gameState != PLAY_STATE && !replayPath) {
+            // Nothing moves on a static screen, so block until a key arrives
+            // and give the wake-up exactly one tick to act on it.
+            waitInput(window, input, &hotkeys);
+            clock.restart();
+            lag = TICK_SECONDS;
+        }
+        else {
+            pollInput(window, input, &hotkeys);
+        }
 
-  
-    sf::Texture alienTexture = loadTexture("alien-strip1.png"); 
-    sf::Texture shipTexture = loadTexture("ship.png"); 
-    sf::Texture shipDeathTexture = loadTexture("ship-strip.png");
+        if (hotkeys.stats) {
+            hotkeys.stats = false;
+            hud.toggleStats();
+        }
+        if (practice && hotkeys.save) {
+            hotkeys.save = false;
+            if (!captureSnapshot(sim, snapshot) || !saveSnapshot(QUICKSAVE_PATH, snapshot)) {
+                std::cerr << "Failed to write " << QUICKSAVE_PATH << std::endl;
+            }
+        }
+        if (practice && hotkeys.load) {
+            hotkeys.load = false;
+            if (loadSnapshot(QUICKSAVE_PATH, snapshot)) {
+                restoreSnapshot(snapshot, sim);
+                previous = sim;
+                rewind.clear();
+                if (telemetry) telemetry->sync(sim);
+                input.take();
+                lag = 0.0f;
+            }
+            else {
+                std::cerr << "Failed to read " << QUICKSAVE_PATH << std::endl;
+            }
+        }
 
-    std::vector<sf::IntRect> movementFrames; 
-    std::vector<sf::IntRect> deathFrames; 
-    std::vector<sf::IntRect> shipDeathFrames;  
-    std::vector<sf::IntRect> wallDeathFrames;
-    int movementFrameWidth = 36; 
-    int movementFrameHeight = 36; 
-    int deathFrameWidth = 36; 
-    int deathFrameHeight = 36; 
-    int shipDeathFrameWidth = 44; 
-    int shipDeathFrameHeight = 44; 
+        float deltaTime = clock.restart().asSeconds(); 
+        lag = std::min(lag + deltaTime, MAX_FRAME_LAG);
+        hud.frameTime(deltaTime);
+        if (telemetry) telemetry->recordFrame(deltaTime, sim);
 
+        while (lag >= TICK_SECONDS) {
+            lag -= TICK_SECONDS;
 
-    loadFrames(movementFrames, movementFrameWidth, movementFrameHeight, 0, 0, 2, 2);
-    loadFrames(deathFrames, deathFrameWidth, deathFrameHeight, 0, 36, 4, 2);
-    loadFrames(shipDeathFrames, shipDeathFrameWidth, shipDeathFrameHeight, 0, 0, 6, 6); 
+            // While R is held every tick steps one snapshot back instead of forward.
+            if (practice && hotkeys.rewind && rewind.rewind(1, snapshot)) {
+                if (lag < TICK_SECONDS) {
+                    previous = sim;
+                }
+                restoreSnapshot(snapshot, sim);
+                if (telemetry) telemetry->sync(sim);
+                input.take();
+                continue;
+            }
 
-     
-    std::vector<std::vector<Alien>> aliens = initializeAliens(alienTexture, movementFrames); 
-    Ship ship = initializeShip(shipTexture);
-    ship.sprite.setTexture(shipDeathTexture);  
+            InputFrame tickInput = input.take();
+            if (latencyStats && input.takeChange(changeTime)) {
+                latencyStats->taken(changeTime);
+            }
 
-    sf::RectangleShape barrier = initializeBarrier(window);
+            if (replayPath && !replay.next(tickInput)) {
+                window.close();
+                break;
+            }
+            recorder.record(tickInput);
 
+            if (lag < TICK_SECONDS) {
+                previous = sim;
+            }
+            sim.step(tickInput, TICK_SECONDS);
+            postSounds(sim, mixer);
+            if (telemetry) telemetry->recordStep(sim);
 
-    std::vector<sf::RectangleShape> bolts;
-    Direction direction = Right;
-    bool moveDown = false;
-    int lives = 3;
-    float alienSpeed = 50.0f;
-    float alienBoltSpeed = 100.0f;
-    int wave = 1;
+            if (practice && sim.gameState == PLAY_STATE && captureSnapshot(sim, snapshot)) {
+                rewind.push(snapshot);
+            }
+        }
+        mixer.update(deltaTime);
 
-    sf::Clock clock;
-    sf::Clock fire;
-    sf::Clock alienFire;
+        sf::RenderTarget& target = frameTarget(window, capture);
+        if (sim.gameState == PLAY_STATE) {
+            playState(target, previous, sim, lag / TICK_SECONDS, getFont(resources, FONT_COMIC_SANS), hud, renderer);
+        }
+        else {
+            menuState(target, menu, sim, resources);
+        }
+        presentFrame(window, capture);
+        if (latencyStats) latencyStats->presented(InputState::Clock::now());
 
-    AlienBolt alienBolt;
-    alienBolt.shape.setSize(sf::Vector2f(8, 30)); 
-    alienBolt.shape.setFillColor(sf::Color::Red); 
-    alienBolt.shape.setPosition(-100, -100);  
+        PROFILE_END_FRAME();
+        allocations.endFrame(frameState, sim.gameState);
+    }
 
-    srand(static_cast<unsigned>(time(0)));
+    std::uint64_t finalHash = hashSimulation(sim);
+    if (recorder.isOpen() && !recorder.close(finalHash)) {
+        std::cerr << "Failed to write replay " << recordPath << std::endl;
+    }
+    if (replayPath) {
+        bool match = replay.finished() && finalHash == replay.finalHash;
+        std::cout << "Replay " << (match ? "matches" : "does NOT match") << " the recording" << std::endl;
+    }
 
-    sf::SoundBuffer shipBoltSound;
-    sf::SoundBuffer alienDestroyedSound;
-    sf::SoundBuffer boltDestoryedSound;
-    sf::SoundBuffer shipTakesDamageSound;
-    if (!shipBoltSound.loadFromFile("pew2.wav")) {
+#if INVADERS_PROFILE
+    if (!profiler().writeCsv("profile.csv")) {
+        std::cerr << "Failed to write profile.csv" << std::endl;
     }
-    if (!alienDestroyedSound.loadFromFile("blast1.wav")) {
+#endif
+    if (capture) {
+        capture->stop();
+        capture->report();
     }
-    if (!boltDestoryedSound.loadFromFile("pop1.wav")) {
+    if (telemetry) {
+        telemetry->stop();
     }
-    if (!shipTakesDamageSound.loadFromFile("blast2.wav")) {
+    if (latencyStats) {
+        latencyStats->print();
     }
-    sf::Sound shipSound(shipBoltSound); 
-    sf::Sound alienDestroyed(alienDestroyedSound);
-    sf::Sound boltDestoryed(boltDestoryedSound); 
-    sf::Sound shipDamage(shipTakesDamageSound);
-
-    
-
-    while (window.isOpen())
-    {
-        sf::Event event;
-        
-        while (window.pollEvent(event))
-        {
-            if (event.type == sf::Event::Closed)
-                window.close();
-
-
-            if (event.type == sf::Event::KeyPressed) { 
-                if (gameState == BEGINNING_STATE && event.key.code == sf::Keyboard::S) {
-                    gameState = PLAY_STATE;
-                }
-
-                else if (gameState == PLAY_STATE && event.key.code == sf::Keyboard::P) {
-                    gameState = PAUSE_STATE;
-                }
-                else if (gameState == PAUSE_STATE && event.key.code == sf::Keyboard::P) { 
-                    gameState = PLAY_STATE;
-                }
-                else if (gameState == NEXT_WAVE_STATE && event.key.code == sf::Keyboard::S) {
-                    aliens = initializeAliens(alienTexture, movementFrames);
-                    barrier = initializeBarrier(window); 
-                    ship.sprite.setPosition(400, 500);   
-                    bolts.clear(); 
-                    alienBolt.active = false; 
-                    alienBolt.shape.setPosition(-100, -100);  
-                    direction = Right;
-                    moveDown = false;
-                    gameState = PLAY_STATE; 
-                }
-                else if (gameState == WINNER_STATE && event.key.code == sf::Keyboard::S) {
-                    aliens = initializeAliens(alienTexture, movementFrames); 
-                    ship.sprite.setPosition(400, 500);  
-                    bolts.clear(); 
-                    lives = 3; 
-                    alienSpeed = 50.0f;
-                    alienBoltSpeed = 100.0f; 
-                    wave = 1;
-                    alienBolt.active = false;
-                    alienBolt.shape.setPosition(-100, -100);
-                    direction = Right; 
-                    moveDown = false; 
-                    gameState = PLAY_STATE;  
-                }
-                else if (gameState == DEFEAT_STATE && event.key.code == sf::Keyboard::S) {
-                    aliens = initializeAliens(alienTexture, movementFrames); 
-                    ship = initializeShip(shipTexture); 
-                    ship.sprite.setTexture(shipDeathTexture); 
-                    ship.sprite.setPosition(400, 500);  
-                    bolts.clear(); 
-                    lives = 3; 
-                    alienSpeed = 50.0f;
-                    alienBoltSpeed = 100.0f; 
-                    wave = 1;
-                    alienBolt.active = false; 
-                    alienBolt.shape.setPosition(-100, -100); 
-                    direction = Right;
-                    moveDown = false; 
-                    gameState = PLAY_STATE;
-                }
-            }
-        }
-
-        float deltaTime = clock.restart().asSeconds(); 
-
-        switch (gameState) {
-            case BEGINNING_STATE:
-                beginState(window);
-                break;
-            case PLAY_STATE: {
-                playState(window, aliens, ship, deltaTime, bolts, fire, direction,moveDown, movementFrames, deathFrames, alienTexture, lives, gameState, alienFire, alienBolt, shipDeathFrames, alienSpeed, alienBoltSpeed, wave, barrier,shipSound, alienDestroyed, boltDestoryed, shipDamage);
-                if (!areAliensRemaining(aliens)) {
-                    wave++;
-                    alienSpeed += 10.0f;
-                    alienBoltSpeed += 5.0f;
-                    gameState = NEXT_WAVE_STATE;
-                    direction = Right; 
-                }
-                if (!areAliensRemaining(aliens) && wave == 12) {
-                    gameState = WINNER_STATE;
-                }
-            }
-                break;
-            case PAUSE_STATE:
-                pauseState(window);
-                break;
-            case NEXT_WAVE_STATE:
-                nextWaveState(window, wave);
-                break;
-            case WINNER_STATE:
-                winnerState(window);
-                break;
-            case DEFEAT_STATE:
-                defeatState(window);
-                
-        }  
+    if (allocCheck) {
+        allocations.print();
+        if (allocations.violations > 0) return 3;
     }
     return 0;
 }
\ No newline at end of file